@@ -152,7 +152,8 @@ RcString Crate::load_extern_crate(Span sp, const RcString& name, const ::std::st
     if(basename == "" && it != g_crate_overrides.end())
     {
         path = it->second;
-        if( !::std::ifstream(path).good() ) {
+        // NOTE: Only the metadata is needed (the library itself may still be being generated, if builds are pipelined)
+        if( !::std::ifstream(path + ".hir").good() ) {
             ERROR(sp, E0000, "Unable to open crate '" << name << "' at path " << path);
         }
         DEBUG("path = " << path << " (--extern)");
@@ -166,7 +167,7 @@ RcString Crate::load_extern_crate(Span sp, const RcString& name, const ::std::st
         {
             path = p + "/" + basename;
 
-            if( ::std::ifstream(path).good() ) {
+            if( ::std::ifstream(path + ".hir").good() ) {
                 // Ensure that if this is loaded, it yields the right name (otherwise skip)
                 auto n = HIR_Deserialise_JustName(path);
                 if( n == name ) {
@@ -174,7 +175,7 @@ RcString Crate::load_extern_crate(Span sp, const RcString& name, const ::std::st
                 }
             }
         }
-        if( !::std::ifstream(path).good() ) {
+        if( !::std::ifstream(path + ".hir").good() ) {
             ERROR(sp, E0000, "Unable to locate crate '" << name << "' with filename " << basename << " in search directories");
         }
         DEBUG("path = " << path << " (basename)");
@@ -8,61 +8,58 @@
 #include <cstdint>
 #include <debug_inner.hpp>
 #include <debug.hpp>
+#include <item_profile.hpp>
 #include <set>
+#include <map>
+#include <mutex>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <common.hpp>   // FmtEscaped
 #include <cstring>	// strchr
+#include <fstream>
+#include <atomic>
+#ifdef _WIN32
+# define NOGDI
+# include <Windows.h>
+# include <Psapi.h>
+# pragma comment(lib, "psapi.lib")
+#else
+# include <unistd.h>
+# include <sys/resource.h>
+#endif
 
 // TODO: Inline debug filter/caching
 // - Cache messages for the current phase, clearing the cache (dropping) when various signatures match
 //  > Similar to the `log_get_last_function.py` script
 
-int g_debug_indent_level = 0;
+thread_local int g_debug_indent_level = 0;
 bool g_debug_enabled = true;
 ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
 
-TraceLog::TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb, ::std::function<void(::std::ostream&)> ret):
-    m_tag(tag),
-    m_ret(ret)
+void TraceLog::open(fmt_fcn_t info_fcn, const void* info_cb)
 {
-    if(debug_enabled() && m_tag) {
+    if(debug_enabled()) {
         auto& os = debug_output(g_debug_indent_level, m_tag);
-        os << ">> (";
-        info_cb(os);
-        os << ")" << ::std::endl;
-    }
-    INDENT();
-}
-TraceLog::TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb):
-    m_tag(tag),
-    m_ret([](const auto&){})
-{
-    if(debug_enabled() && m_tag) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
-        os << ">> (";
-        info_cb(os);
-        os << ")" << ::std::endl;
+        if( info_fcn ) {
+            os << ">> (";
+            info_fcn(info_cb, os);
+            os << ")" << ::std::endl;
+        }
+        else {
+            os << ">>" << ::std::endl;
+        }
     }
-    INDENT();
 }
-TraceLog::TraceLog(const char* tag):
-    m_tag(tag),
-    m_ret([](const auto&){})
+void TraceLog::close()
 {
-    if(debug_enabled() && m_tag) {
-        auto& os = debug_output(g_debug_indent_level, m_tag);
-        os << ">>" << ::std::endl;
-    }
-    INDENT();
-}
-TraceLog::~TraceLog() {
-    UNINDENT();
-    if(debug_enabled() && m_tag) {
+    if(debug_enabled()) {
         auto& os = debug_output(g_debug_indent_level, m_tag);
         os << "<< (";
-        m_ret(os);
+        if( m_ret_fcn ) {
+            m_ret_fcn(m_ret_cb, os);
+        }
         os << ")" << ::std::endl;
     }
 }
@@ -77,33 +74,279 @@ bool debug_enabled_update() {
         return true;
     }
 }
-bool debug_enabled()
-{
-    return g_debug_enabled;
-}
 ::std::ostream& debug_output(int indent, const char* function)
 {
     return ::std::cout << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
 }
 
+// --- Phase timing ---
+namespace {
+    /// Current resident set size, in bytes
+    uint64_t get_rss()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if( GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) )
+            return pmc.WorkingSetSize;
+        return 0;
+#else
+        ::std::ifstream is("/proc/self/statm");
+        uint64_t size = 0, resident = 0;
+        if( is >> size >> resident )
+            return resident * sysconf(_SC_PAGESIZE);
+        return 0;
+#endif
+    }
+    /// Peak resident set size, in bytes
+    uint64_t get_peak_rss()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if( GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) )
+            return pmc.PeakWorkingSetSize;
+        return 0;
+#else
+        struct rusage   ru;
+        if( getrusage(RUSAGE_SELF, &ru) != 0 )
+            return 0;
+# ifdef __APPLE__
+        return ru.ru_maxrss;
+# else
+        return static_cast<uint64_t>(ru.ru_maxrss) * 1024;
+# endif
+#endif
+    }
+
+    struct TimingOutput
+    {
+        ::std::ofstream lines;
+        ::std::ofstream trace;
+        ::std::chrono::steady_clock::time_point    base = ::std::chrono::steady_clock::now();
+        bool    first_event = true;
+
+        ~TimingOutput()
+        {
+            if( trace.is_open() )
+            {
+                trace << "\n]\n";
+            }
+        }
+    } g_timing_output;
+}
+
+namespace {
+    DebugPhaseCounter*  g_phase_counters = nullptr;
+}
+DebugPhaseCounter::DebugPhaseCounter(const char* name):
+    m_name(name),
+    m_value(0),
+    m_next(g_phase_counters)
+{
+    g_phase_counters = this;
+}
+
+void debug_timing_open(const char* path)
+{
+    g_timing_output.lines.open(path);
+    if( !g_timing_output.lines.is_open() ) {
+        ::std::cerr << "WARN: Unable to open `" << path << "` for phase timing output" << ::std::endl;
+        return ;
+    }
+    g_timing_output.trace.open(::std::string(path) + ".trace.json");
+    if( !g_timing_output.trace.is_open() ) {
+        ::std::cerr << "WARN: Unable to open `" << path << ".trace.json` for phase timing output" << ::std::endl;
+    }
+    else {
+        g_timing_output.trace << "[";
+    }
+}
+
 DebugTimedPhase::DebugTimedPhase(const char* name):
     m_name(name)
 {
     ::std::cout << m_name << ": V V V" << ::std::endl;
     g_cur_phase = m_name;
     g_debug_enabled = debug_enabled_update();
+    m_start_rss = g_timing_output.lines.is_open() ? get_rss() : 0;
+    m_start_allocs = debug_alloc_count();
+    for(const auto* c = g_phase_counters; c; c = c->m_next)
+        m_start_counters.push_back(c->m_value.load(::std::memory_order_relaxed));
+    m_start_wall = ::std::chrono::steady_clock::now();
     m_start = clock();
 }
 DebugTimedPhase::~DebugTimedPhase()
 {
     auto end = clock();
+    auto end_wall = ::std::chrono::steady_clock::now();
+    auto allocs = debug_alloc_count() - m_start_allocs;
     g_cur_phase = "";
     g_debug_enabled = debug_enabled_update();
 
-    // TODO: Show wall time too?
-    ::std::cout << "(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - m_start) / static_cast<double>(CLOCKS_PER_SEC) << " s) ";
+    auto cpu_us = static_cast<uint64_t>( static_cast<double>(end - m_start) * 1e6 / static_cast<double>(CLOCKS_PER_SEC) );
+    auto wall_us = static_cast<uint64_t>( ::std::chrono::duration_cast<::std::chrono::microseconds>(end_wall - m_start_wall).count() );
+
+    ::std::cout << "(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(cpu_us) / 1e6 << " s";
+    ::std::cout << ", wall " << static_cast<double>(wall_us) / 1e6 << " s) ";
     ::std::cout << m_name << ": DONE";
+    // Counters that changed during this phase
+    ::std::vector<::std::pair<const char*, uint64_t>>   counters;
+    {
+        size_t i = 0;
+        for(const auto* c = g_phase_counters; c && i < m_start_counters.size(); c = c->m_next, i ++)
+        {
+            auto delta = c->m_value.load(::std::memory_order_relaxed) - m_start_counters[i];
+            if( delta > 0 ) {
+                counters.push_back(::std::make_pair(c->m_name, delta));
+            }
+        }
+    }
+    if( !counters.empty() )
+    {
+        ::std::cout << " (";
+        for(const auto& c : counters)
+            ::std::cout << (&c == &counters.front() ? "" : ", ") << c.first << "=" << c.second;
+        ::std::cout << ")";
+    }
     ::std::cout << ::std::endl;
+
+    if( g_timing_output.lines.is_open() )
+    {
+        auto rss = get_rss();
+        auto peak_rss = get_peak_rss();
+        int64_t rss_delta = static_cast<int64_t>(rss) - static_cast<int64_t>(m_start_rss);
+        auto start_us = ::std::chrono::duration_cast<::std::chrono::microseconds>(m_start_wall - g_timing_output.base).count();
+
+        auto emit_fields = [&](::std::ostream& os) {
+            os << "\"wall_us\":" << wall_us
+               << ",\"cpu_us\":" << cpu_us
+               << ",\"rss_kb\":" << rss / 1024
+               << ",\"rss_delta_kb\":" << rss_delta / 1024
+               << ",\"peak_rss_kb\":" << peak_rss / 1024
+               << ",\"allocs\":" << allocs
+               ;
+            for(const auto& c : counters)
+                os << ",\"" << FmtEscaped(c.first) << "\":" << c.second;
+            };
+
+        auto& os = g_timing_output.lines;
+        os << "{\"phase\":\"" << FmtEscaped(m_name) << "\",\"start_us\":" << start_us << ",";
+        emit_fields(os);
+        os << "}" << ::std::endl;
+
+        if( g_timing_output.trace.is_open() )
+        {
+            auto& ts = g_timing_output.trace;
+            ts << (g_timing_output.first_event ? "\n" : ",\n");
+            g_timing_output.first_event = false;
+            ts << "{\"name\":\"" << FmtEscaped(m_name) << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+               << ",\"ts\":" << start_us << ",\"dur\":" << wall_us
+               << ",\"args\":{";
+            emit_fields(ts);
+            ts << "}}";
+            ts.flush();
+        }
+    }
+}
+
+// --- Per-item profiling ---
+bool g_item_profile_enabled = false;
+namespace {
+    struct ItemProfileRecord
+    {
+        uint64_t    total_us = 0;
+        uint64_t    calls = 0;
+        ::std::map<::std::string, uint64_t>   counters;
+    };
+    struct ItemProfileState
+    {
+        ::std::mutex    lock;
+        unsigned    top_n = 0;
+        // category -> item -> record
+        ::std::map<::std::string, ::std::map<::std::string, ItemProfileRecord>>  records;
+    };
+    ItemProfileState& item_profile_state() {
+        static ItemProfileState s;
+        return s;
+    }
+    thread_local ItemProfileScope* t_item_profile_cur = nullptr;
+
+    void item_profile_report()
+    {
+        auto& state = item_profile_state();
+        ::std::lock_guard<::std::mutex> lh(state.lock);
+        auto& os = ::std::cout;
+        for(const auto& cat : state.records)
+        {
+            ::std::vector<const ::std::pair<const ::std::string, ItemProfileRecord>*> sorted;
+            uint64_t    total = 0;
+            for(const auto& e : cat.second) {
+                sorted.push_back(&e);
+                total += e.second.total_us;
+            }
+            ::std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+                return a->second.total_us > b->second.total_us || (a->second.total_us == b->second.total_us && a->first < b->first);
+                });
+            os << "=== " << cat.first << ": " << cat.second.size() << " items, "
+                << ::std::fixed << ::std::setprecision(3) << static_cast<double>(total) / 1e6 << " s total ===\n";
+            for(size_t i = 0; i < sorted.size() && i < state.top_n; i ++)
+            {
+                const auto& r = sorted[i]->second;
+                os << ::std::setw(10) << ::std::setprecision(3) << static_cast<double>(r.total_us) / 1e3 << " ms "
+                    << ::std::setw(5) << r.calls << "x " << sorted[i]->first;
+                for(const auto& c : r.counters) {
+                    os << " " << c.first << "=" << c.second;
+                }
+                os << "\n";
+            }
+        }
+        os << ::std::flush;
+    }
+}
+void item_profile_enable(unsigned top_n)
+{
+    item_profile_state().top_n = top_n;
+    if( !g_item_profile_enabled ) {
+        g_item_profile_enabled = true;
+        ::std::atexit(item_profile_report);
+    }
+}
+void item_profile_count(const char* name, uint64_t value)
+{
+    if( t_item_profile_cur ) {
+        t_item_profile_cur->add_count(name, value);
+    }
+}
+void ItemProfileScope::add_count(const char* name, uint64_t value)
+{
+    if( !m_category )
+        return ;
+    for(auto& c : m_counters) {
+        if( c.first == name || ::std::strcmp(c.first, name) == 0 ) {
+            c.second += value;
+            return ;
+        }
+    }
+    m_counters.push_back(::std::make_pair(name, value));
+}
+void ItemProfileScope::start()
+{
+    m_parent = t_item_profile_cur;
+    t_item_profile_cur = this;
+    m_start = ::std::chrono::steady_clock::now();
+}
+void ItemProfileScope::finish()
+{
+    auto d = ::std::chrono::steady_clock::now() - m_start;
+    t_item_profile_cur = m_parent;
+
+    auto& state = item_profile_state();
+    ::std::lock_guard<::std::mutex> lh(state.lock);
+    auto& r = state.records[m_category][m_item];
+    r.total_us += ::std::chrono::duration_cast<::std::chrono::microseconds>(d).count();
+    r.calls += 1;
+    for(const auto& c : m_counters) {
+        r.counters[c.first] += c.second;
+    }
 }
 
 extern void debug_init_phases(const char* env_var_name, std::initializer_list<const char*> il)
@@ -0,0 +1,60 @@
+/*
+ * MRustC - Mutabah's Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * debug_alloc.cpp
+ * - Global allocation counting (for phase statistics)
+ *
+ * NOTE: Kept in its own file so no `new`/`delete` pairs are inlined against the replacement operators
+ */
+#include <debug_inner.hpp>
+#include <cstdlib>  // malloc/free
+#include <new>
+
+namespace {
+    ::std::atomic<uint64_t> g_alloc_count { 0 };
+}
+
+uint64_t debug_alloc_count()
+{
+    return g_alloc_count.load(::std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+    g_alloc_count.fetch_add(1, ::std::memory_order_relaxed);
+    if( size == 0 )
+        size = 1;
+    for(;;)
+    {
+        if( void* rv = ::std::malloc(size) )
+            return rv;
+        auto handler = ::std::get_new_handler();
+        if( !handler )
+            throw ::std::bad_alloc();
+        handler();
+    }
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void* operator new(size_t size, const ::std::nothrow_t&) noexcept
+{
+    try {
+        return operator new(size);
+    }
+    catch(const ::std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const ::std::nothrow_t& nt) noexcept
+{
+    return operator new(size, nt);
+}
+void operator delete(void* ptr) noexcept { ::std::free(ptr); }
+void operator delete[](void* ptr) noexcept { ::std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { ::std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { ::std::free(ptr); }
+void operator delete(void* ptr, const ::std::nothrow_t&) noexcept { ::std::free(ptr); }
+void operator delete[](void* ptr, const ::std::nothrow_t&) noexcept { ::std::free(ptr); }
@@ -262,6 +262,12 @@ struct ProcMacroInv:
     } handles;
     bool    m_eof_hit = false;
 
+    /// Pending output to the child (written in one go before blocking on a read, or once large)
+    ::std::vector<uint8_t>  m_send_buf;
+    /// Data read from the child but not yet consumed
+    ::std::vector<uint8_t>  m_recv_buf;
+    size_t  m_recv_ofs = 0;
+
 public:
     ProcMacroInv(const Span& sp, AST::Edition edition, const char* executable, const ::HIR::ProcMacro& proc_macro_desc);
     ProcMacroInv(const ProcMacroInv&) = delete;
@@ -273,6 +279,7 @@ public:
     bool check_good();
     void send_done() {
         this->send_u8(static_cast<uint8_t>(TokenClass::EndOfStream));
+        this->flush_send();
         m_dump_file_out.flush();
         DEBUG("Input tokens sent");
     }
@@ -395,6 +402,8 @@ public:
     virtual Ident::Hygiene realGetHygiene() const override;
 private:
     Token realGetToken_();
+    void flush_send();
+    void recv_fill();
     void send_u8(uint8_t v);
     void send_bytes(const void* val, size_t size);
     void send_bytes_raw(const void* val, size_t size);
@@ -1654,6 +1663,12 @@ namespace {
         });
 }
 
+namespace {
+    // Output is flushed before every blocking read, this just bounds the memory used for large inputs
+    const size_t SEND_BUFFER_SIZE = 64*1024;
+    const size_t RECV_BUFFER_SIZE = 16*1024;
+}
+
 ProcMacroInv::ProcMacroInv(const Span& sp, AST::Edition edition, const char* executable, const ::HIR::ProcMacro& proc_macro_desc):
     TokenStream(ParseState()),
     m_parent_span(sp),
@@ -1839,29 +1854,38 @@ ProcMacroInv::~ProcMacroInv()
 }
 bool ProcMacroInv::check_good()
 {
-    char    v;
-#ifdef _WIN32
-    DWORD rv = 0;
-    if( !ReadFile(this->handles.child_stdout, &v, 1, &rv, nullptr) )
+    this->flush_send();
+    if( m_recv_ofs == m_recv_buf.size() )
     {
-        DEBUG("Error reading from child, " << GetLastError());
-        return false;
-    }
+        // Errors/EOF here are reported as a failure to start, not a BUG
+#ifdef _WIN32
+        DWORD rv = 0;
+        m_recv_buf.resize(RECV_BUFFER_SIZE);
+        if( !ReadFile(this->handles.child_stdout, m_recv_buf.data(), m_recv_buf.size(), &rv, nullptr) )
+        {
+            DEBUG("Error reading from child, " << GetLastError());
+            m_recv_buf.clear();
+            return false;
+        }
 #else
-    int rv = read(this->handles.child_stdout, &v, 1);
+        m_recv_buf.resize(RECV_BUFFER_SIZE);
+        auto rv = read(this->handles.child_stdout, m_recv_buf.data(), m_recv_buf.size());
+        if( rv < 0 )
+        {
+            DEBUG("Error reading from child, rv=" << rv << " " << strerror(errno));
+            m_recv_buf.clear();
+            return false;
+        }
 #endif
-    if( rv == 0 )
-    {
-        DEBUG("Unexpected EOF from child");
-        return false;
-    }
-#ifndef _WIN32
-    if( rv < 0 )
-    {
-        DEBUG("Error reading from child, rv=" << rv << " " << strerror(errno));
-        return false;
+        m_recv_buf.resize(rv);
+        m_recv_ofs = 0;
+        if( rv == 0 )
+        {
+            DEBUG("Unexpected EOF from child");
+            return false;
+        }
     }
-#endif
+    auto v = this->recv_u8();
     DEBUG("Child started, value = " << (int)v);
     if( v != 0 )
         return false;
@@ -1880,14 +1904,32 @@ void ProcMacroInv::send_bytes_raw(const void* val, size_t size)
 {
     if( m_dump_file_out.is_open() )
         m_dump_file_out.write( reinterpret_cast<const char*>(val), size);
+    const auto* p = reinterpret_cast<const uint8_t*>(val);
+    m_send_buf.insert(m_send_buf.end(), p, p + size);
+    if( m_send_buf.size() >= SEND_BUFFER_SIZE )
+        this->flush_send();
+}
+void ProcMacroInv::flush_send()
+{
+    const uint8_t* p = m_send_buf.data();
+    size_t  rem = m_send_buf.size();
+    while( rem > 0 )
+    {
 #ifdef _WIN32
-    DWORD bytesWritten = 0;
-    if( !WriteFile(this->handles.child_stdin, val, size, &bytesWritten, nullptr) || bytesWritten != size )
-        BUG(m_parent_span, "Error writing to child, " << GetLastError());
+        DWORD n = 0;
+        if( !WriteFile(this->handles.child_stdin, p, rem, &n, nullptr) )
+            BUG(m_parent_span, "Error writing to child, " << GetLastError());
 #else
-    if( write(this->handles.child_stdin, val, size) != static_cast<ssize_t>(size) )
-        BUG(m_parent_span, "Error writing to child, " << strerror(errno));
+        auto n = write(this->handles.child_stdin, p, rem);
+        if( n < 0 && errno == EINTR )
+            continue ;
+        if( n <= 0 )
+            BUG(m_parent_span, "Error writing to child, " << strerror(errno));
 #endif
+        p += n;
+        rem -= n;
+    }
+    m_send_buf.clear();
 }
 void ProcMacroInv::send_v128u(uint64_t val)
 {
@@ -1922,25 +1964,43 @@ uint8_t ProcMacroInv::recv_u8()
 
     return val;
 }
+void ProcMacroInv::recv_fill()
+{
+    // Anything the child is waiting on has to be sent before blocking
+    this->flush_send();
+    m_recv_buf.resize(RECV_BUFFER_SIZE);
+#ifdef _WIN32
+    DWORD n = 0;
+    if( !ReadFile(this->handles.child_stdout, m_recv_buf.data(), m_recv_buf.size(), &n, nullptr) ) {
+        BUG(this->m_parent_span, "Error while reading from child process, " << GetLastError());
+    }
+#else
+    ssize_t n;
+    do {
+        n = read(this->handles.child_stdout, m_recv_buf.data(), m_recv_buf.size());
+    } while( n < 0 && errno == EINTR );
+    if( n < 0 ) {
+        BUG(this->m_parent_span, "Error while reading from child process, " << strerror(errno));
+    }
+#endif
+    if( n == 0 ) {
+        BUG(this->m_this_span, "Unexpected EOF while reading from child process");
+    }
+    m_recv_buf.resize(n);
+    m_recv_ofs = 0;
+}
 void ProcMacroInv::recv_bytes_raw(void* out_void, size_t len)
 {
     uint8_t* val = reinterpret_cast<uint8_t*>(out_void);
     size_t  ofs = 0, rem = len;
     while( rem > 0 )
     {
-#ifdef _WIN32
-        DWORD n;
-        ReadFile(this->handles.child_stdout, &val[ofs], rem, &n, nullptr);
-#else
-        auto n = read(this->handles.child_stdout, &val[ofs], rem);
-#endif
-        if( n == 0 ) {
-            BUG(this->m_this_span, "Unexpected EOF while reading from child process");
-        }
-        if( n < 0 ) {
-            BUG(this->m_parent_span, "Error while reading from child process");
+        if( m_recv_ofs == m_recv_buf.size() ) {
+            this->recv_fill();
         }
-        assert(static_cast<size_t>(n) <= rem);
+        size_t n = ::std::min(rem, m_recv_buf.size() - m_recv_ofs);
+        memcpy(&val[ofs], m_recv_buf.data() + m_recv_ofs, n);
+        m_recv_ofs += n;
         ofs += n;
         rem -= n;
     }
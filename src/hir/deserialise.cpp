@@ -16,15 +16,14 @@ namespace {
 #include <mir/mir.hpp>
 #include <macro_rules/macro_rules.hpp>
 #include "serialise_lowlevel.hpp"
+#include <debug_inner.hpp>
 #include <typeinfo>
 
 namespace {
     bool des_debug_enabled() {
-        static unsigned enabled = 0;
-        if( enabled == 0 ) {
-            enabled = (getenv("MRUSTC_DEBUG_DESERIALISE") ? 2 : 1);
-        }
-        return enabled > 1;
+        // NOTE: Static initialisation, as MIR bodies can be loaded on worker threads
+        static const bool enabled = (getenv("MRUSTC_DEBUG_DESERIALISE") != nullptr);
+        return enabled;
     }
 }
 
@@ -38,10 +37,23 @@ namespace {
     class HirDeserialiser
     {
         RcString m_crate_name;
-        ::std::vector<HIR::TypeRef> m_types;
+        /// Types decoded by this deserialiser (indexed from `m_parent_types_count`)
+        ::std::shared_ptr<::std::vector<HIR::TypeRef>>  m_types;
+        /// When decoding a MIR chunk: the enclosing stream's types that the chunk can refer to
+        ::std::shared_ptr<const ::std::vector<HIR::TypeRef>>    m_parent_types;
+        size_t  m_parent_types_count;
         ::HIR::serialise::Reader&   m_in;
     public:
         HirDeserialiser(::HIR::serialise::Reader& in):
+            m_types(::std::make_shared<::std::vector<HIR::TypeRef>>()),
+            m_parent_types_count(0),
+            m_in(in)
+        {}
+        HirDeserialiser(::HIR::serialise::Reader& in, RcString crate_name, ::std::shared_ptr<const ::std::vector<HIR::TypeRef>> parent_types, size_t parent_types_count):
+            m_crate_name(::std::move(crate_name)),
+            m_types(::std::make_shared<::std::vector<HIR::TypeRef>>()),
+            m_parent_types(::std::move(parent_types)),
+            m_parent_types_count(parent_types_count),
             m_in(in)
         {}
 
@@ -463,6 +475,7 @@ namespace {
             rv.m_param_names = deserialise_vec<RcString>();
             rv.m_pattern = deserialise_vec_c< ::SimplePatEnt>( [&](){ return deserialise_simplepatent(); } );
             rv.m_contents = deserialise_vec_c< ::MacroExpansionEnt>( [&](){ return deserialise_macroexpansionent(); } );
+            rv.update_lead_tok();
             return rv;
         }
         ::MacroExpansionEnt deserialise_macroexpansionent() {
@@ -523,18 +536,9 @@ namespace {
         ::HIR::ConstGeneric deserialise_constgeneric();
         EncodedLiteral deserialise_encodedliteral();
 
-        ::HIR::ExprPtr deserialise_exprptr()
-        {
-            ::HIR::ExprPtr  rv;
-            auto _ = m_in.open_object("HIR::ExprPtr");
-            if( m_in.read_bool() )
-            {
-                rv.m_mir = deserialise_mir();
-            }
-            rv.m_erased_types = deserialise_vec< ::HIR::TypeRef>();
-            return rv;
-        }
+        ::HIR::ExprPtr deserialise_exprptr();
         ::MIR::FunctionPointer deserialise_mir();
+        ::MIR::Function deserialise_mir_function();
         ::MIR::BasicBlock deserialise_mir_basicblock();
         ::MIR::Statement deserialise_mir_statement();
         AsmCommon::Options deserialise_asm_options();
@@ -1079,11 +1083,16 @@ namespace {
         auto idx = m_in.read_count();
         if( idx != ~0u ) {
             DEBUG("#" << idx << "");
-            rv = m_types.at(idx).clone();
+            if( idx < m_parent_types_count ) {
+                rv = (*m_parent_types)[idx].clone();
+            }
+            else {
+                rv = m_types->at(idx - m_parent_types_count).clone();
+            }
             return rv;
         }
         else {
-            DEBUG("Fresh (=" << m_types.size() << ")");
+            DEBUG("Fresh (=" << m_parent_types_count + m_types->size() << ")");
         }
         auto _ = m_in.open_object("HIR::TypeData");
 
@@ -1148,7 +1157,7 @@ namespace {
         default:
             BUG(Span(), "Bad tag for HIR::TypeRef - " << tag);
         }
-        m_types.push_back(rv.clone());
+        m_types->push_back(rv.clone());
         return rv;
     }
 
@@ -1442,7 +1451,66 @@ namespace {
         return rv;
     }
 
+    namespace {
+        DebugPhaseCounter   s_lazy_mir_loaded("MIR bodies loaded");
+
+        /// A MIR body stored as a separately decodable chunk, only decoded when first used
+        class LazyMirChunk:
+            public ::MIR::LazyFunction
+        {
+            RcString    m_crate_name;
+            ::std::shared_ptr<const ::std::vector<RcString>>    m_strings;
+            ::std::shared_ptr<const ::std::vector<HIR::TypeRef>>    m_types;
+            size_t  m_types_count;
+            ::std::vector<uint8_t>  m_data;
+        public:
+            LazyMirChunk(RcString crate_name, ::std::shared_ptr<const ::std::vector<RcString>> strings, ::std::shared_ptr<const ::std::vector<HIR::TypeRef>> types, size_t types_count, ::std::vector<uint8_t> data):
+                m_crate_name(::std::move(crate_name)),
+                m_strings(::std::move(strings)),
+                m_types(::std::move(types)),
+                m_types_count(types_count),
+                m_data(::std::move(data))
+            {
+            }
+
+            ::MIR::Function* load() override
+            {
+                s_lazy_mir_loaded.inc();
+                ::HIR::serialise::Reader    in { m_strings, m_data };
+                HirDeserialiser s { in, m_crate_name, m_types, m_types_count };
+                return new ::MIR::Function( s.deserialise_mir_function() );
+            }
+        };
+    }
+
+    ::HIR::ExprPtr HirDeserialiser::deserialise_exprptr()
+    {
+        ::HIR::ExprPtr  rv;
+        auto _ = m_in.open_object("HIR::ExprPtr");
+        switch( auto tag = m_in.read_tag() )
+        {
+        case 0:
+            break;
+        case 1:
+            rv.m_mir = deserialise_mir();
+            break;
+        case 2: {
+            ASSERT_BUG(Span(), !m_parent_types, "Nested MIR chunk");
+            auto n_types = m_in.read_count();
+            ASSERT_BUG(Span(), n_types <= m_types->size(), "MIR chunk refers to " << n_types << " types, only " << m_types->size() << " loaded");
+            rv.m_mir = ::MIR::FunctionPointer(new LazyMirChunk(m_crate_name, m_in.strings(), m_types, n_types, m_in.read_chunk()));
+            break; }
+        default:
+            BUG(Span(), "Bad tag for HIR::ExprPtr - " << tag);
+        }
+        rv.m_erased_types = deserialise_vec< ::HIR::TypeRef>();
+        return rv;
+    }
     ::MIR::FunctionPointer HirDeserialiser::deserialise_mir()
+    {
+        return ::MIR::FunctionPointer( new ::MIR::Function(deserialise_mir_function()) );
+    }
+    ::MIR::Function HirDeserialiser::deserialise_mir_function()
     {
         TRACE_FUNCTION;
 
@@ -1453,7 +1521,7 @@ namespace {
         rv.drop_flags = deserialise_vec<bool>();
         rv.blocks = deserialise_vec< ::MIR::BasicBlock>( );
 
-        return ::MIR::FunctionPointer( new ::MIR::Function(mv$(rv)) );
+        return rv;
     }
     ::MIR::BasicBlock HirDeserialiser::deserialise_mir_basicblock()
     {
@@ -1714,6 +1782,8 @@ namespace {
 
         rv.m_ext_libs = deserialise_vec< ::HIR::ExternLibrary>();
         rv.m_link_paths = deserialise_vec< ::std::string>();
+        rv.m_shared_instances = deserialise_set< ::std::string>();
+        rv.m_short_symbols = m_in.read_bool();
 
         //rv.m_proc_macros = deserialise_vec< ::HIR::ProcMacro>();
 
@@ -377,6 +377,11 @@ const ::HIR::TypeItem& ::HIR::Crate::get_typeitem_by_path(const Span& sp, const
     return it->second->ent;
 }
 
+::std::mutex& ::HIR::Crate::new_items_lock()
+{
+    static ::std::mutex s_lock;
+    return s_lock;
+}
 const ::HIR::Module& ::HIR::Crate::get_mod_by_path(const Span& sp, const ::HIR::SimplePath& path, bool ignore_last_node/*=false*/, bool ignore_crate_name/*=false*/) const
 {
     if( ignore_last_node )
@@ -469,16 +474,18 @@ const ::HIR::ValueItem& ::HIR::Crate::get_valitem_by_path(const Span& sp, const
     if( path.crate_name() == "#intrinsics" ) {
         ASSERT_BUG(sp, path.components().size() == 1, "");
         if( path.components().back() == "offset_of" ) {
-            if( ! g_val_item_intrnsic_offsetof.as_Function().m_variadic ) {
+            static ::std::once_flag s_init_offsetof;
+            ::std::call_once(s_init_offsetof, [](){
                 auto& v =  g_val_item_intrnsic_offsetof.as_Function();
                 v.m_variadic = true;
                 v.m_params.m_types.push_back(HIR::TypeParamDef { RcString::new_interned("T"), {}, true });
-            }
+                });
             return g_val_item_intrnsic_offsetof;
         }
         TODO(sp, "Get intrinsic " << path.components().back());
     }
     if( path.crate_name() == this->m_crate_name && path.components().size() == 1 ) {
+        ::std::lock_guard<::std::mutex> lh { new_items_lock() };
         auto i = std::find_if(m_new_values.begin(), m_new_values.end(), [&](const auto& v){ return v.first == path.components().back(); });
         if( i != m_new_values.end() ) {
             return i->second->ent;
@@ -522,6 +529,7 @@ const ::HIR::Static& ::HIR::Crate::get_static_by_path(const Span& sp, const ::HI
         }
     }
     if( path.crate_name() == this->m_crate_name && path.components().size() == 1 ) {
+        ::std::lock_guard<::std::mutex> lh { new_items_lock() };
         auto i = std::find_if(m_new_values.begin(), m_new_values.end(), [&](const auto& v){ return v.first == path.components().back(); });
         if( i != m_new_values.end() ) {
             return i->second->ent.as_Static();
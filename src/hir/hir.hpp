@@ -14,7 +14,9 @@
 #include <cassert>
 #include <unordered_map>
 #include <vector>
+#include <set>
 #include <memory>
+#include <mutex>
 
 #include <tagged_union.hpp>
 
@@ -29,6 +31,7 @@
 #include <hir/crate_ptr.hpp>
 #include <hir/encoded_literal.hpp>
 #include <hir/inherent_cache.hpp>
+#include <hir/trait_impl_cache.hpp>
 #include <hir/asm.hpp>
 
 class Monomorphiser;
@@ -652,15 +655,23 @@ public:
     // Placeholder for types created during constant evaluation
     mutable std::vector<std::pair<RcString, std::unique_ptr<VisEnt<TypeItem>> >>  m_new_types;
     mutable std::vector<std::pair<RcString, std::unique_ptr<VisEnt<ValueItem>> >> m_new_values;
+    /// Lock for `m_new_types`/`m_new_values`, which on-demand expansion can push to while typecheck workers look up items
+    static ::std::mutex& new_items_lock();
+
+    /// CACHE: Per-list impl type fingerprints and type-shape buckets (defined in hir_ops.cpp)
+    struct ImplGroupIndex;
 
     template<typename T>
     struct ImplGroup
     {
         typedef ::std::vector<T> list_t;
         ::std::map<::HIR::SimplePath, list_t>   named;
-        list_t  non_named; // TODO: use a map of HIR::TypeRef::Data::Tag
+        list_t  non_named; // NOTE: Bucketed by type shape in `m_index` (for the post-resolve `m_all_*` groups)
         list_t  generic;
 
+        /// CACHE: Lazily built on lookup, entries are rebuilt when their list changes size
+        mutable ::std::shared_ptr<ImplGroupIndex>   m_index;
+
         const list_t* get_list_for_type(const ::HIR::TypeRef& ty) const {
             static list_t empty;
             if( const auto* p = ty.get_sort_path() ) {
@@ -693,6 +704,8 @@ public:
 
     /// CACHE: Cache of all inherent (non-trait) methods (for faster lookup)
     InherentCache   m_inherent_method_cache;
+    /// CACHE: Memoised trait impl searches for fully-known types (see `TraitImplCache`)
+    mutable TraitImplCache  m_trait_impl_cache;
 
     /// Impl blocks
     ::std::map< ::HIR::SimplePath, ImplGroup<::std::unique_ptr<::HIR::TraitImpl>> > m_trait_impls;
@@ -721,6 +734,12 @@ public:
     ::std::vector<ExternLibrary>    m_ext_libs;
     /// Extra paths for the linker
     ::std::vector<::std::string>    m_link_paths;
+    /// Mangled names of generic instances this crate emits with (weak) external linkage
+    /// - Downstream crates link to these instead of emitting their own copy (see `Trans_Enumerate_RecordShared`)
+    ::std::set<::std::string>   m_shared_instances;
+    /// Symbol mangling mode this crate was compiled with (`-C short-symbols`)
+    /// - Downstream crates must use the same mode, or references to this crate's symbols won't resolve
+    bool    m_short_symbols = false;
 
     /// Method called to populate runtime state after deserialisation
     /// See hir/crate_post_load.cpp
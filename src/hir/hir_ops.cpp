@@ -15,6 +15,9 @@
 #include <hir_expand/main_bindings.hpp>
 #include <mir/main_bindings.hpp>
 #include <trans/target.hpp>
+#include <debug_inner.hpp>
+#include <array>
+#include <mutex>
 
 namespace {
     bool is_unbounded_infer(const ::HIR::TypeRef& type) {
@@ -883,6 +886,165 @@ bool ::HIR::TraitImpl::overlaps_with(const Crate& crate, const ::HIR::TraitImpl&
 
 namespace
 {
+    /// Fast-reject fingerprint: the shape code of a type, followed by the codes of its first few child types
+    /// - A code of zero is a wildcard (the type could match anything, e.g. a generic or an ivar)
+    typedef ::std::array<uint32_t, 4>   ImplFingerprint;
+}
+struct HIR::Crate::ImplGroupIndex
+{
+    struct ListIndex {
+        /// Number of list entries covered, entries pushed after the index was built are checked unfiltered
+        size_t  size;
+        ::std::vector<ImplFingerprint>  fingerprints;
+        /// Entry indexes grouped on the top-level code of the impl type (wildcard entries are kept separate)
+        ::std::unordered_map<uint32_t, ::std::vector<size_t>>   buckets;
+        ::std::vector<size_t>   wildcards;
+    };
+    /// Keyed on the address of the list within the owning group
+    ::std::unordered_map<const void*, ::std::shared_ptr<const ListIndex>>   lists;
+};
+namespace
+{
+    DebugPhaseCounter   s_counter_impl_lists_indexed("impl_lists_indexed");
+    DebugPhaseCounter   s_counter_impl_fast_rejects("impl_fast_rejects");
+    ::std::mutex    s_impl_index_lock;
+
+    size_t hash_combine(size_t h, size_t v) {
+        return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+    size_t hash_simplepath(const ::HIR::SimplePath& p) {
+        size_t  h = ::std::hash<RcString>()(p.crate_name());
+        for(const auto& c : p.components())
+            h = hash_combine(h, ::std::hash<RcString>()(c));
+        return h;
+    }
+
+    const ::HIR::TypeRef& resolve_for_code(const ::HIR::TypeRef& ty, ::HIR::t_cb_resolve_type ty_res) {
+        return (ty.data().is_Infer() || ty.data().is_Generic()) ? ty_res.get_type(Span(), ty) : ty;
+    }
+    /// Code for the outermost layer of a type, following the tag-mismatch rules of `MatchGenerics::cmp_type`
+    /// - Anything that can fuzzy-match a different shape (ivars, generics, opaque/unbound paths, ...) gets zero
+    uint32_t type_code(const ::HIR::TypeRef& ty_in, ::HIR::t_cb_resolve_type ty_res)
+    {
+        const auto& ty = resolve_for_code(ty_in, ty_res);
+        size_t  h = static_cast<size_t>(ty.data().tag()) + 1;
+        TU_MATCH_HDRA( (ty.data()), {)
+        TU_ARMA(Infer, e)   return 0;
+        TU_ARMA(Generic, e) return 0;
+        TU_ARMA(ErasedType, e)  return 0;
+        TU_ARMA(NamedFunction, e)   return 0;
+        TU_ARMA(Closure, e) return 0;
+        TU_ARMA(Generator, e)   return 0;
+        TU_ARMA(Diverge, e) {
+            }
+        TU_ARMA(Primitive, e) {
+            h = hash_combine(h, static_cast<size_t>(e));
+            }
+        TU_ARMA(Path, e) {
+            if( e.binding.is_Unbound() || e.binding.is_Opaque() || !e.path.m_data.is_Generic() )
+                return 0;
+            h = hash_combine(h, hash_simplepath(e.path.m_data.as_Generic().m_path));
+            }
+        TU_ARMA(TraitObject, e) {
+            h = hash_combine(h, hash_simplepath(e.m_trait.m_path.m_path));
+            }
+        TU_ARMA(Array, e) {
+            }
+        TU_ARMA(Slice, e) {
+            }
+        TU_ARMA(Tuple, e) {
+            h = hash_combine(h, e.size());
+            }
+        TU_ARMA(Borrow, e) {
+            h = hash_combine(h, static_cast<size_t>(e.type));
+            }
+        TU_ARMA(Pointer, e) {
+            h = hash_combine(h, static_cast<size_t>(e.type));
+            }
+        TU_ARMA(Function, e) {
+            h = hash_combine(h, e.m_arg_types.size());
+            }
+        }
+        auto rv = static_cast<uint32_t>(h ^ (h >> 16 >> 16));
+        return rv == 0 ? 1 : rv;
+    }
+    ImplFingerprint type_fingerprint(const ::HIR::TypeRef& ty_in, ::HIR::t_cb_resolve_type ty_res)
+    {
+        ImplFingerprint rv {{ 0, 0, 0, 0 }};
+        rv[0] = type_code(ty_in, ty_res);
+        if( rv[0] == 0 )
+            return rv;
+        size_t  n = 1;
+        auto push = [&](const ::HIR::TypeRef& t) {
+            if( n < rv.size() )
+                rv[n++] = type_code(t, ty_res);
+            };
+        const auto& ty = resolve_for_code(ty_in, ty_res);
+        if( const auto* e = ty.data().opt_Path() ) {
+            for(const auto& t : e->path.m_data.as_Generic().m_params.m_types)
+                push(t);
+        }
+        else if( const auto* e = ty.data().opt_TraitObject() ) {
+            for(const auto& t : e->m_trait.m_path.m_params.m_types)
+                push(t);
+        }
+        else if( const auto* e = ty.data().opt_Tuple() ) {
+            for(const auto& t : *e)
+                push(t);
+        }
+        else if( const auto* e = ty.data().opt_Function() ) {
+            for(const auto& t : e->m_arg_types)
+                push(t);
+        }
+        else if( const auto* e = ty.data().opt_Borrow() )   push(e->inner);
+        else if( const auto* e = ty.data().opt_Pointer() )  push(e->inner);
+        else if( const auto* e = ty.data().opt_Slice() )    push(e->inner);
+        else if( const auto* e = ty.data().opt_Array() )    push(e->inner);
+        return rv;
+    }
+    /// Returns false if an impl with fingerprint `impl_fp` can never match a type with fingerprint `fp`
+    bool fingerprint_compatible(const ImplFingerprint& impl_fp, const ImplFingerprint& fp)
+    {
+        if( impl_fp[0] == 0 || fp[0] == 0 )
+            return true;
+        if( impl_fp[0] != fp[0] )
+            return false;
+        for(size_t i = 1; i < fp.size(); i ++)
+        {
+            if( impl_fp[i] != 0 && fp[i] != 0 && impl_fp[i] != fp[i] )
+                return false;
+        }
+        return true;
+    }
+
+    template<typename ImplType>
+    ::std::shared_ptr<const ::HIR::Crate::ImplGroupIndex::ListIndex> get_list_index(const ::HIR::Crate::ImplGroup<const ImplType*>& group, const ::std::vector<const ImplType*>& impl_list)
+    {
+        ::std::lock_guard<::std::mutex> lh(s_impl_index_lock);
+        if( !group.m_index ) {
+            group.m_index = ::std::make_shared<::HIR::Crate::ImplGroupIndex>();
+        }
+        auto& slot = group.m_index->lists[&impl_list];
+        if( !slot || slot->size != impl_list.size() )
+        {
+            s_counter_impl_lists_indexed.inc();
+            auto li = ::std::make_shared<::HIR::Crate::ImplGroupIndex::ListIndex>();
+            li->size = impl_list.size();
+            li->fingerprints.reserve(impl_list.size());
+            for(size_t i = 0; i < impl_list.size(); i ++)
+            {
+                auto fp = type_fingerprint(impl_list[i]->m_type, ::HIR::ResolvePlaceholdersNop());
+                if( fp[0] == 0 )
+                    li->wildcards.push_back(i);
+                else
+                    li->buckets[fp[0]].push_back(i);
+                li->fingerprints.push_back(fp);
+            }
+            slot = mv$(li);
+        }
+        return slot;
+    }
+
     template<typename ImplType>
     bool find_impls_list(const typename ::HIR::Crate::ImplGroup<::std::unique_ptr<ImplType>>::list_t& impl_list, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, ::std::function<bool(const ImplType&)> callback)
     {
@@ -913,6 +1075,49 @@ namespace
         }
         return false;
     }
+    /// Search a list from an indexed (`m_all_*`) group, only visiting the impls whose fingerprint is compatible with `fp`
+    template<typename ImplType>
+    bool find_impls_list_indexed(const ::HIR::Crate::ImplGroup<const ImplType*>& group, const ::std::vector<const ImplType*>& impl_list, const ImplFingerprint& fp, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, ::std::function<bool(const ImplType&)> callback)
+    {
+        if( fp[0] == 0 ) {
+            return find_impls_list<ImplType>(impl_list, type, ty_res, callback);
+        }
+        auto idx = get_list_index(group, impl_list);
+
+        auto check = [&](size_t i)->bool {
+            if( !fingerprint_compatible(idx->fingerprints[i], fp) ) {
+                s_counter_impl_fast_rejects.inc();
+                return false;
+            }
+            const auto& impl = *impl_list[i];
+            return impl.matches_type(type, ty_res) && callback(impl);
+            };
+
+        // Merge the bucket for this type's shape with the wildcard entries, keeping the original list order
+        static const ::std::vector<size_t>  empty;
+        auto bit = idx->buckets.find(fp[0]);
+        const auto& bucket = (bit != idx->buckets.end() ? bit->second : empty);
+        auto it_b = bucket.begin();
+        auto it_w = idx->wildcards.begin();
+        while( it_b != bucket.end() || it_w != idx->wildcards.end() )
+        {
+            size_t  i;
+            if( it_w == idx->wildcards.end() || (it_b != bucket.end() && *it_b < *it_w) )
+                i = *it_b++;
+            else
+                i = *it_w++;
+            if( check(i) )
+                return true;
+        }
+        // Entries added after the index was built
+        for(size_t i = idx->size; i < impl_list.size(); i ++)
+        {
+            const auto& impl = *impl_list[i];
+            if( impl.matches_type(type, ty_res) && callback(impl) )
+                return true;
+        }
+        return false;
+    }
 }
 namespace
 {
@@ -1016,7 +1221,7 @@ bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR:
             // 1. Find named impls (associated with named types)
             if( const auto* impl_list = it->second.get_list_for_type(type) )
             {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
+                if( find_impls_list_indexed(it->second, *impl_list, type_fingerprint(type, ty_res), type, ty_res, callback) )
                     return true;
             }
             // - If the type is an ivar, search all types
@@ -1086,7 +1291,7 @@ bool ::HIR::Crate::find_auto_trait_impls(const ::HIR::SimplePath& trait, const :
             // 1. Find named impls (associated with named types)
             if( const auto* impl_list = it->second.get_list_for_type(type) )
             {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
+                if( find_impls_list_indexed(it->second, *impl_list, type_fingerprint(type, ty_res), type, ty_res, callback) )
                     return true;
             }
 
@@ -1135,7 +1340,7 @@ bool ::HIR::Crate::find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type
         // 1. Find named impls (associated with named types)
         if( const auto* impl_list = this->m_all_type_impls.get_list_for_type(type) )
         {
-            if( find_impls_list(*impl_list, type, ty_res, callback) )
+            if( find_impls_list_indexed(this->m_all_type_impls, *impl_list, type_fingerprint(type, ty_res), type, ty_res, callback) )
                 return true;
         }
 
@@ -15,6 +15,8 @@
     class HirSerialiser
     {
         ::std::map<std::string, size_t>    m_types;
+        /// Types added to `m_types` while writing a chunk (removed at the end of the chunk)
+        ::std::vector<::std::map<std::string, size_t>::iterator>  m_chunk_types;
         ::HIR::serialise::Writer&   m_out;
     public:
         HirSerialiser(::HIR::serialise::Writer& out):
@@ -281,7 +283,10 @@
                 break;
             }
 
-            m_types.insert(std::make_pair( std::move(ty_str), m_types.size() ));
+            auto it_new = m_types.insert(std::make_pair( std::move(ty_str), m_types.size() )).first;
+            if( m_out.in_chunk() ) {
+                m_chunk_types.push_back(it_new);
+            }
         }
         void serialise_simplepath(const ::HIR::SimplePath& path)
         {
@@ -452,6 +457,8 @@
             }
             serialise_vec(crate.m_ext_libs);
             serialise_vec(crate.m_link_paths);
+            serialise(crate.m_shared_instances);
+            m_out.write_bool(crate.m_short_symbols);
         }
         void serialise(const ::HIR::ExternLibrary& lib)
         {
@@ -731,10 +738,26 @@
         {
             auto _ = m_out.open_object("HIR::ExprPtr");
             save_mir &= static_cast<bool>(exp.m_mir);
-            m_out.write_bool( save_mir );
-            if( save_mir ) {
+            if( !save_mir ) {
+                m_out.write_tag(0);
+            }
+            else if( m_out.in_chunk() ) {
+                m_out.write_tag(1);
                 serialise(*exp.m_mir);
             }
+            else {
+                // Emit MIR as a chunk so the loader can defer decoding it until it's used.
+                // - The chunk can only refer to types cached before it started.
+                m_out.write_tag(2);
+                m_out.write_count(m_types.size());
+                m_out.begin_chunk();
+                serialise(*exp.m_mir);
+                m_out.end_chunk();
+                for(auto it : m_chunk_types) {
+                    m_types.erase(it);
+                }
+                m_chunk_types.clear();
+            }
             serialise_vec( exp.m_erased_types );
         }
         void serialise(const ::MIR::Function& mir)
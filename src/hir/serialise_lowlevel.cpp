@@ -32,7 +32,8 @@ public:
 };
 
 Writer::Writer():
-    m_inner(nullptr)
+    m_inner(nullptr),
+    m_in_chunk(false)
 {
 }
 Writer::~Writer()
@@ -68,7 +69,13 @@ void Writer::open(const ::std::string& filename)
 }
 void Writer::write(const void* buf, size_t len)
 {
-    if( m_inner ) {
+    if( m_in_chunk ) {
+        if( m_inner ) {
+            const auto* p = reinterpret_cast<const uint8_t*>(buf);
+            m_chunk_data.insert(m_chunk_data.end(), p, p + len);
+        }
+    }
+    else if( m_inner ) {
         DEBUG("write(" << FMT_CB(ss, for(size_t i = 0; i < len; i ++) ss << std::setw(2) << std::setfill('0') << std::hex << unsigned( ((const uint8_t*)buf)[i] )) << ")");
         m_inner->write(buf, len);
     }
@@ -76,6 +83,22 @@ void Writer::write(const void* buf, size_t len)
         // No-op, pre caching
     }
 }
+void Writer::begin_chunk()
+{
+    assert(!m_in_chunk);
+    m_in_chunk = true;
+    m_chunk_data.clear();
+    m_chunk_saved_objname_cache.clear();
+    ::std::swap(m_chunk_saved_objname_cache, m_objname_cache);
+}
+void Writer::end_chunk()
+{
+    assert(m_in_chunk);
+    m_in_chunk = false;
+    ::std::swap(m_chunk_saved_objname_cache, m_objname_cache);
+    this->raw_write_bytes(m_chunk_data.size(), m_chunk_data.data());
+    m_chunk_data.clear();
+}
 void Writer::write_string(const RcString& v)
 {
     if( m_inner ) {
@@ -233,16 +256,29 @@ void ReadBuffer::populate(ReaderInner& is)
 Reader::Reader(const ::std::string& filename):
     m_inner( new ReaderInner(filename) ),
     m_buffer(1024),
-    m_pos(0)
+    m_pos(0),
+    m_mem_data(nullptr),
+    m_mem_size(0)
 {
     size_t n_strings = read_count();
-    m_strings.reserve(n_strings);
+    auto strings = ::std::make_shared<::std::vector<RcString>>();
+    strings->reserve(n_strings);
     DEBUG("n_strings = " << n_strings);
     for(size_t i = 0; i < n_strings; i ++)
     {
         auto s = read_string();
-        m_strings.push_back( RcString::new_interned(s) );
+        strings->push_back( RcString::new_interned(s) );
     }
+    m_strings = ::std::move(strings);
+}
+Reader::Reader(::std::shared_ptr<const ::std::vector<RcString>> strings, const ::std::vector<uint8_t>& data):
+    m_inner(nullptr),
+    m_buffer(0),
+    m_pos(0),
+    m_strings(::std::move(strings)),
+    m_mem_data(data.data()),
+    m_mem_size(data.size())
+{
 }
 Reader::~Reader()
 {
@@ -251,6 +287,14 @@ Reader::~Reader()
 
 void Reader::read(void* buf, size_t len)
 {
+    if( !m_inner )
+    {
+        if( len > m_mem_size - m_pos )
+            throw ::std::runtime_error( FMT("Reader::read - Requested " << len << " bytes from chunk, only " << (m_mem_size - m_pos) << " left") );
+        memcpy(buf, m_mem_data + m_pos, len);
+        m_pos += len;
+        return ;
+    }
     auto used = m_buffer.read(buf, len);
     if( used == len ) {
         m_pos += len;
@@ -22,6 +22,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 #include <stddef.h>
 #include <assert.h>
 #include <rc_string.hpp>
@@ -37,6 +38,11 @@ class Writer
     WriterInner*    m_inner;
     ::std::map<RcString, unsigned>  m_istring_cache;
     ::std::map<const char*, unsigned>  m_objname_cache;
+
+    /// Set while writing a chunk (see `begin_chunk`)
+    bool    m_in_chunk;
+    ::std::vector<uint8_t>  m_chunk_data;
+    ::std::map<const char*, unsigned>  m_chunk_saved_objname_cache;
 public:
     Writer();
     Writer(const Writer&) = delete;
@@ -46,6 +52,14 @@ public:
     void open(const ::std::string& filename);
     void write(const void* data, size_t count);
 
+    /// Start a separately decodable chunk
+    /// - Output is buffered until `end_chunk`, which emits it as a length-prefixed blob
+    /// - The chunk uses its own object name cache, so can be decoded without the rest of the stream
+    ///   (the string table is shared)
+    void begin_chunk();
+    void end_chunk();
+    bool in_chunk() const { return m_in_chunk; }
+
     void write_u8(uint8_t v) {
         write(reinterpret_cast<const char*>(&v), 1);
     }
@@ -240,11 +254,17 @@ class Reader
     ReaderInner*    m_inner;
     ReadBuffer  m_buffer;
     size_t  m_pos;
-    ::std::vector<RcString> m_strings;
+    ::std::shared_ptr<const ::std::vector<RcString>>    m_strings;
+
+    /// Backing data when reading a chunk from memory (`m_inner` is null)
+    const uint8_t*  m_mem_data;
+    size_t  m_mem_size;
 
     ::std::vector<std::string>  m_objname_cache;
 public:
     Reader(const ::std::string& path);
+    /// Read a chunk (emitted by `Writer::end_chunk`) from memory, using a string table from a file reader
+    Reader(::std::shared_ptr<const ::std::vector<RcString>> strings, const ::std::vector<uint8_t>& data);
     Reader(const Writer&) = delete;
     Reader(Writer&&) = delete;
     ~Reader();
@@ -362,7 +382,7 @@ public:
     }
     RcString read_istring() {
         size_t idx = read_count();
-        return m_strings.at(idx);
+        return m_strings->at(idx);
     }
     ::std::string read_string() {
         size_t len = read_u8();
@@ -429,6 +449,16 @@ public:
         read( const_cast<char*>(rv.data()), len );
         return rv;
     }
+    /// Read a chunk emitted by `Writer::end_chunk`, returning its raw bytes
+    ::std::vector<uint8_t> read_chunk() {
+        auto len = raw_read_len();
+        ::std::vector<uint8_t>  rv(len);
+        read( rv.data(), len );
+        return rv;
+    }
+    const ::std::shared_ptr<const ::std::vector<RcString>>& strings() const {
+        return m_strings;
+    }
 
 
     class CloseOnDrop {
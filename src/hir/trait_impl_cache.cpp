@@ -0,0 +1,112 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir/trait_impl_cache.cpp
+ * - Memoised trait impl search results
+ */
+#include "trait_impl_cache.hpp"
+#include <hir/hir.hpp>
+#include <hir_typeck/common.hpp>    // visit_ty_with
+#include <debug_inner.hpp>
+#include <mutex>
+
+namespace {
+    DebugPhaseCounter   s_counter_hits("trait_impl_cache_hits");
+    DebugPhaseCounter   s_counter_misses("trait_impl_cache_misses");
+    // Guards the entry maps (resolvers on worker threads share the crate's cache)
+    // - Not held while searching, as the match callback can recurse into the cache
+    ::std::mutex    s_entries_lock;
+
+    bool values_known(const ::HIR::PathParams& params)
+    {
+        for(const auto& v : params.m_values)
+        {
+            if( !v.is_Evaluated() )
+                return false;
+        }
+        return true;
+    }
+}
+
+void HIR::TraitImplCache::clear()
+{
+    ::std::lock_guard<::std::mutex> lh { s_entries_lock };
+    if( !m_entries.empty() ) {
+        DEBUG("Clearing " << m_entries.size() << " entries");
+    }
+    m_entries.clear();
+}
+
+bool HIR::TraitImplCache::is_cacheable(const ::HIR::TypeRef& ty)
+{
+    return !visit_ty_with(ty, [](const ::HIR::TypeRef& t)->bool {
+        TU_MATCH_HDRA( (t.data()), {)
+        default:
+            return false;
+        // Depend on the current scope (or on ivar state)
+        TU_ARMA(Infer, _e)      return true;
+        TU_ARMA(Generic, _e)    return true;
+        TU_ARMA(ErasedType, _e) return true;
+        // Get impls added to the crate later on
+        TU_ARMA(Closure, _e)    return true;
+        TU_ARMA(Generator, _e)  return true;
+        TU_ARMA(Array, e) {
+            return !e.size.is_Known();
+            }
+        TU_ARMA(Path, e) {
+            // Associated types may expand differently depending on scope
+            if( !e.path.m_data.is_Generic() )
+                return true;
+            if( !( e.binding.is_Struct() || e.binding.is_Enum() || e.binding.is_Union() || e.binding.is_ExternType() ) )
+                return true;
+            return !values_known(e.path.m_data.as_Generic().m_params);
+            }
+        }
+        throw "";
+        });
+}
+
+const HIR::TraitImplCache::impl_list_t* HIR::TraitImplCache::get(
+    const ::HIR::Crate& crate, Resolver res,
+    const ::HIR::SimplePath& trait, const ::HIR::PathParams* params, const ::HIR::TypeRef& type,
+    t_cb_match match
+    )
+{
+    if( !m_enabled || !params )
+        return nullptr;
+    if( !is_cacheable(type) )
+        return nullptr;
+    for(const auto& ty : params->m_types)
+    {
+        if( !is_cacheable(ty) )
+            return nullptr;
+    }
+    if( !values_known(*params) )
+        return nullptr;
+
+    auto key = ::std::make_tuple(res, ::HIR::GenericPath(trait, params->clone()), type.clone());
+    {
+        ::std::lock_guard<::std::mutex> lh { s_entries_lock };
+        auto it = m_entries.find(key);
+        if( it != m_entries.end() )
+        {
+            s_counter_hits.inc();
+            return &it->second;
+        }
+    }
+    s_counter_misses.inc();
+
+    // NOTE: `match` can recurse into this cache, so populate a local list before inserting
+    impl_list_t impls;
+    crate.find_trait_impls(trait, type, ::HIR::ResolvePlaceholdersNop(), [&](const ::HIR::TraitImpl& impl) {
+        if( match(impl) ) {
+            impls.push_back(&impl);
+        }
+        return false;
+        });
+    DEBUG(trait << *params << " for " << type << ": " << impls.size() << " impls");
+    ::std::lock_guard<::std::mutex> lh { s_entries_lock };
+    // NOTE: Another thread may have inserted the same entry while this one searched, either result is the same
+    return &m_entries.insert(::std::make_pair(mv$(key), mv$(impls))).first->second;
+}
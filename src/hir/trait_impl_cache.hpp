@@ -0,0 +1,63 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * hir/trait_impl_cache.hpp
+ * - Memoised trait impl search results
+ */
+#pragma once
+#include "type.hpp"
+#include "path.hpp"
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace HIR {
+
+class Crate;
+class TraitImpl;
+
+/// <summary>
+/// Cache of the impls selected by `Crate::find_trait_impls` for fully-known `(trait, params, type)` queries
+/// </summary>
+/// Only the set of impls that matched is stored (an empty set is a cached negative result), callers re-check the
+/// cached impls to obtain an `ImplRef` - so callback semantics are unchanged.
+/// 
+/// Must be cleared (via `clear`) whenever trait impls are added to (or modified in) the crate.
+class TraitImplCache
+{
+public:
+    /// Which resolver populated the entry (the two have subtly different matching rules)
+    enum class Resolver {
+        Static,
+        Typeck,
+    };
+    typedef ::std::vector<const ::HIR::TraitImpl*> impl_list_t;
+    /// Returns true if the impl matches the query
+    typedef ::std::function<bool(const ::HIR::TraitImpl& impl)>  t_cb_match;
+
+private:
+    typedef ::std::tuple<Resolver, ::HIR::GenericPath, ::HIR::TypeRef> key_t;
+
+    bool    m_enabled = false;
+    ::std::map<key_t, impl_list_t>  m_entries;
+
+public:
+    /// Enable the cache - impl headers must not change after this point (other than through invalidation points)
+    void enable() {
+        m_enabled = true;
+    }
+    /// Invalidation point: discard all cached results
+    void clear();
+
+    /// Obtain the list of matching impls for a query
+    /// - Returns `nullptr` if the query cannot be cached (cache is disabled, or the query isn't fully known)
+    /// - On a cache miss, all candidate impls are passed to `match` and the matching ones are recorded
+    const impl_list_t* get(const ::HIR::Crate& crate, Resolver res, const ::HIR::SimplePath& trait, const ::HIR::PathParams* params, const ::HIR::TypeRef& type, t_cb_match match);
+
+    /// Returns true if the result of a trait search for this type is independent of the current generic scope
+    static bool is_cacheable(const ::HIR::TypeRef& ty);
+};
+
+}
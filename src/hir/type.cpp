@@ -8,7 +8,11 @@
 #include "type.hpp"
 #include <span.hpp>
 #include "expr.hpp" // Hack for cloning array types
+#include <hir_typeck/common.hpp>    // clone_ty_with
+#include <debug_inner.hpp>
 #include <cstdint>
+#include <mutex>
+#include <unordered_map>
 
 namespace HIR {
 
@@ -388,6 +392,9 @@ bool ::HIR::TypeRef::operator==(const ::HIR::TypeRef& x) const
 
     if( !m_ptr || !x.m_ptr )
         return false;
+    // Equal types share a single interned instance
+    if( m_ptr->m_interned && x.m_ptr->m_interned )
+        return false;
     if( data().tag() != x.data().tag() )
         return false;
 
@@ -1167,6 +1174,179 @@ HIR::TypeData_NamedFunction_Ty HIR::TypeData_NamedFunction_Ty::clone() const {
 {
     return HIR::TypeRef(*this);
 }
+namespace {
+    DebugPhaseCounter   s_counter_interned("types_interned");
+    DebugPhaseCounter   s_counter_intern_hits("type_intern_hits");
+    // Interned types, bucketed by structural hash
+    // - Entries are never removed, the table holds a reference to each
+    ::std::unordered_map<size_t, ::std::vector<HIR::TypeRef>>  s_interned_types;
+    ::std::mutex    s_interned_types_lock;
+
+    size_t hash_combine(size_t h, size_t v) {
+        return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+    bool params_resolved(const HIR::PathParams& pp) {
+        for(const auto& v : pp.m_values)
+            if( !(v.is_Evaluated() || v.is_Generic()) )
+                return false;
+        return true;
+    }
+    bool path_resolved(const HIR::Path& p) {
+        TU_MATCH_HDRA( (p.m_data), {)
+        TU_ARMA(Generic, e) {
+            return params_resolved(e.m_params);
+            }
+        TU_ARMA(UfcsInherent, e) {
+            return params_resolved(e.params) && params_resolved(e.impl_params);
+            }
+        TU_ARMA(UfcsKnown, e) {
+            return params_resolved(e.trait.m_params) && params_resolved(e.params);
+            }
+        TU_ARMA(UfcsUnknown, e) {
+            return false;
+            }
+        }
+        throw "";
+    }
+}
+bool HIR::TypeRef::is_interned() const
+{
+    return m_ptr && m_ptr->m_interned;
+}
+::HIR::TypeRef HIR::TypeRef::intern() const
+{
+    assert(m_ptr);
+    if( m_ptr->m_interned )
+        return clone();
+
+    // Check that this layer is fully known, and that it would survive being cloned
+    bool is_resolved = true;
+    if( data().is_Infer() ) {
+        is_resolved = false;
+    }
+    else if( const auto* e = data().opt_Path() ) {
+        is_resolved = !e->binding.is_Opaque() && !e->hrtbs && path_resolved(e->path);
+    }
+    else if( const auto* e = data().opt_NamedFunction() ) {
+        is_resolved = path_resolved(e->path);
+    }
+    else if( const auto* e = data().opt_Array() ) {
+        is_resolved = e->size.is_Known();
+    }
+    if( !is_resolved )
+        return clone();
+
+    // Copy the top layer, interning all inner types (so they can be hashed and compared by pointer)
+    auto rv = clone_ty_with(Span(), *this, [&](const ::HIR::TypeRef& tpl, ::HIR::TypeRef& out)->bool {
+        if( &tpl == this )
+            return false;
+        out = tpl.intern();
+        is_resolved &= out.is_interned();
+        return true;
+        });
+    if( !is_resolved )
+        return clone();
+
+    // Hash the top layer, using the (cached) hashes of the inner types
+    auto hash_ty = [](const ::HIR::TypeRef& t) { return t.m_ptr->m_hash; };
+    auto hash_params = [&](size_t h, const ::HIR::PathParams& pp) {
+        for(const auto& t : pp.m_types)
+            h = hash_combine(h, hash_ty(t));
+        return h;
+    };
+    auto hash_gpath = [&](const ::HIR::GenericPath& gp) {
+        const auto& sp = gp.m_path;
+        return hash_params(::std::hash<RcString>()(sp.components().empty() ? sp.crate_name() : sp.components().back()), gp.m_params);
+    };
+    auto hash_path = [&](const ::HIR::Path& p)->size_t {
+        TU_MATCH_HDRA( (p.m_data), {)
+        TU_ARMA(Generic, e) {
+            return hash_gpath(e);
+            }
+        TU_ARMA(UfcsInherent, e) {
+            return hash_params(hash_combine(hash_ty(e.type), ::std::hash<RcString>()(e.item)), e.params);
+            }
+        TU_ARMA(UfcsKnown, e) {
+            return hash_params(hash_combine(hash_combine(hash_ty(e.type), hash_gpath(e.trait)), ::std::hash<RcString>()(e.item)), e.params);
+            }
+        TU_ARMA(UfcsUnknown, e) {
+            return hash_params(hash_combine(hash_ty(e.type), ::std::hash<RcString>()(e.item)), e.params);
+            }
+        }
+        throw "";
+    };
+    size_t  hash = static_cast<size_t>(rv.data().tag());
+    TU_MATCH_HDRA( (rv.data()), {)
+    TU_ARMA(Infer, e) {
+        throw "";
+        }
+    TU_ARMA(Diverge, e) {
+        }
+    TU_ARMA(Primitive, e) {
+        hash = hash_combine(hash, static_cast<size_t>(e));
+        }
+    TU_ARMA(Path, e) {
+        hash = hash_combine(hash, hash_path(e.path));
+        }
+    TU_ARMA(Generic, e) {
+        hash = hash_combine(hash, e.binding);
+        }
+    TU_ARMA(TraitObject, e) {
+        hash = hash_combine(hash, hash_gpath(e.m_trait.m_path));
+        for(const auto& m : e.m_markers)
+            hash = hash_combine(hash, hash_gpath(m));
+        }
+    TU_ARMA(ErasedType, e) {
+        // Rare, so just the tag is used
+        }
+    TU_ARMA(Array, e) {
+        hash = hash_combine(hash_combine(hash, hash_ty(e.inner)), static_cast<size_t>(e.size.as_Known()));
+        }
+    TU_ARMA(Slice, e) {
+        hash = hash_combine(hash, hash_ty(e.inner));
+        }
+    TU_ARMA(Tuple, e) {
+        for(const auto& t : e)
+            hash = hash_combine(hash, hash_ty(t));
+        }
+    TU_ARMA(Borrow, e) {
+        hash = hash_combine(hash_combine(hash, static_cast<size_t>(e.type)), hash_ty(e.inner));
+        }
+    TU_ARMA(Pointer, e) {
+        hash = hash_combine(hash_combine(hash, static_cast<size_t>(e.type)), hash_ty(e.inner));
+        }
+    TU_ARMA(NamedFunction, e) {
+        hash = hash_combine(hash, hash_path(e.path));
+        }
+    TU_ARMA(Function, e) {
+        hash = hash_combine(hash, e.is_unsafe);
+        for(const auto& t : e.m_arg_types)
+            hash = hash_combine(hash, hash_ty(t));
+        hash = hash_combine(hash, hash_ty(e.m_rettype));
+        }
+    TU_ARMA(Closure, e) {
+        hash = hash_combine(hash, reinterpret_cast<::std::uintptr_t>(e.node));
+        }
+    TU_ARMA(Generator, e) {
+        hash = hash_combine(hash, reinterpret_cast<::std::uintptr_t>(e.node));
+        }
+    }
+
+    ::std::lock_guard<::std::mutex> lh { s_interned_types_lock };
+    auto& bucket = s_interned_types[hash];
+    for(const auto& ent : bucket)
+    {
+        if( ent == rv ) {
+            s_counter_intern_hits.inc();
+            return ent.clone();
+        }
+    }
+    s_counter_interned.inc();
+    rv.m_ptr->m_interned = true;
+    rv.m_ptr->m_hash = hash;
+    bucket.push_back(rv.clone());
+    return rv;
+}
 ::HIR::TypeRef HIR::TypeRef::clone_shallow() const
 {
     TU_MATCH_HDRA( (data()), {)
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <tagged_union.hpp>
+#include <atomic>
 #include <hir/path.hpp>
 #include <hir/expr_ptr.hpp>
 #include <span.hpp>
@@ -261,12 +262,18 @@ public:
     // Existing TypeRef
 
 private:
-    unsigned    m_refcount;
+    ::std::atomic<unsigned> m_refcount;
+    /// This is the shared instance held by the type interner (see `TypeRef::intern`)
+    bool    m_interned;
+    /// Structural hash, only valid if `m_interned`
+    size_t  m_hash;
 public:
     TypeData   m_data;
 private:
     TypeInner(TypeData d):
         m_refcount(1),
+        m_interned(false),
+        m_hash(0),
         m_data(mv$(d))
     {
     }
@@ -283,14 +290,13 @@ inline TypeRef::TypeRef(TypeData d):
 inline TypeRef::TypeRef(const TypeRef& x):
     m_ptr(x.m_ptr)
 {
-    x.m_ptr->m_refcount += 1;
+    x.m_ptr->m_refcount.fetch_add(1, ::std::memory_order_relaxed);
 }
 inline TypeRef::~TypeRef()
 {
     if(m_ptr)
     {
-        m_ptr->m_refcount -= 1;
-        if(m_ptr->m_refcount == 0)
+        if(m_ptr->m_refcount.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
         {
             delete m_ptr;
             m_ptr = nullptr;
@@ -298,7 +304,8 @@ inline TypeRef::~TypeRef()
     }
 }
 inline const TypeData& TypeRef::data() const { assert(m_ptr); return m_ptr->m_data; }
-inline TypeData& TypeRef::data_mut() { assert(m_ptr); return m_ptr->m_data; }
+// NOTE: Interned instances are shared by everything with an equal type, so are copied before being mutated
+inline TypeData& TypeRef::data_mut() { assert(m_ptr); if(m_ptr->m_interned) *this = this->clone_shallow(); return m_ptr->m_data; }
 inline TypeData& TypeRef::get_unique() { assert(m_ptr); if(m_ptr->m_refcount != 1) *this = this->clone_shallow(); return m_ptr->m_data; }
 
 
@@ -121,6 +121,11 @@ public:
     TypeRef clone() const;
     /// Create a new instance by copying TypeData (only one layer deep)
     TypeRef clone_shallow() const;
+    /// Get the shared instance of this type from the global interner (adding it if not already present)
+    /// - Equal types then share one allocation, so comparing them is a pointer check
+    /// - Types that aren't fully resolved (containing ivars or unevaluated constants) are returned unchanged
+    TypeRef intern() const;
+    bool is_interned() const;
     ///// Duplicate recursively
     //TypeRef clone_deep() const;
     void fmt(::std::ostream& os) const;
@@ -20,6 +20,7 @@
 #include "constant_evaluation.hpp"
 #include <trans/monomorphise.hpp>   // For handling monomorph of MIR in provided associated constants
 #include <trans/codegen.hpp>    // For encoding as part of transmute
+#include <mutex>
 
 namespace {
     static const ::HIR::TypeRef  ty_Self = ::HIR::TypeRef::new_self();
@@ -3639,6 +3640,12 @@ namespace {
     }
 }   // namespace
 
+namespace {
+    /// On-demand evaluation (from typecheck and monomorphisation) writes to shared items: lazily evaluated constants,
+    /// new statics, and MIR generated for `const fn`s. These entry points are serialised so parallel workers can call them.
+    ::std::recursive_mutex  s_consteval_lock;
+}
+
 void ConvertHIR_ConstantEvaluate(::HIR::Crate& crate)
 {
     Expander    exp { crate };
@@ -3663,6 +3670,7 @@ void ConvertHIR_ConstantEvaluate(::HIR::Crate& crate)
 void ConvertHIR_ConstantEvaluate_Expr(const ::HIR::Crate& crate, const ::HIR::ItemPath& ip, ::HIR::ExprPtr& expr_ptr)
 {
     TRACE_FUNCTION_F(ip);
+    ::std::lock_guard<::std::recursive_mutex>   lh { s_consteval_lock };
     // Check innards but NOT the value
     Expander    exp { crate };
     exp.visit_expr( expr_ptr );
@@ -3675,10 +3683,16 @@ void ConvertHIR_ConstantEvaluate_Enum(const ::HIR::Crate& crate, const ::HIR::It
 
     auto& item = const_cast<::HIR::Enum&>(enm);
 
+    ::std::lock_guard<::std::recursive_mutex>   lh { s_consteval_lock };
     Expander::visit_enum_inner(crate, ip, mod, mod_path, item_name.c_str(), item);
 }
 void ConvertHIR_ConstantEvaluate_ConstGeneric( const Span& sp, const ::HIR::Crate& crate, const HIR::TypeRef& ty, ::HIR::ConstGeneric& cg )
 {
+    // NOTE: Types shared between typecheck workers are evaluated before the parallel phase (see `Typecheck_Expressions`)
+    // - So an unlocked check is safe, anything still unevaluated is only reachable from the calling thread
+    if( !cg.is_Unevaluated() )
+        return ;
+    ::std::lock_guard<::std::recursive_mutex>   lh { s_consteval_lock };
     if( auto* cge_p = cg.opt_Unevaluated() )
     {
         const auto& cge = *cge_p;
@@ -3719,6 +3733,9 @@ void ConvertHIR_ConstantEvaluate_ConstGeneric( const Span& sp, const ::HIR::Crat
 
 void ConvertHIR_ConstantEvaluate_ArraySize(const Span& sp, const ::HIR::Crate& crate, const ::HIR::SimplePath& path, ::HIR::ArraySize& size)
 {
+    if( !size.is_Unevaluated() )
+        return ;
+    ::std::lock_guard<::std::recursive_mutex>   lh { s_consteval_lock };
     if( auto* se = size.opt_Unevaluated() ) {
         if(se->is_Unevaluated()) {
             ConvertHIR_ConstantEvaluate_ConstGeneric(sp, crate, HIR::CoreType::Usize, *se);
@@ -3756,6 +3773,7 @@ void ConvertHIR_ConstantEvaluate_MethodParams(
     {
         if(v.is_Unevaluated())
         {
+            ::std::lock_guard<::std::recursive_mutex>   lh { s_consteval_lock };
             const auto& ue = *v.as_Unevaluated();
             const auto& e = *ue.expr;
             auto name = FMT("param_" << &v << "#");
@@ -1126,6 +1126,7 @@ void ConvertHIR_ResolveUFCS_SortImpls(::HIR::Crate& crate)
     for(const auto& ec : crate.m_ext_crates) {
         push_index_impls(crate, *ec.second.m_data);
     }
+    crate.m_trait_impl_cache.clear();
 
     {
         const auto& lang_Box = crate.get_lang_item_path_opt("owned_box");
@@ -104,6 +104,7 @@ namespace {
             trait_impl_list_r.push_back(ptr.get());
             auto& trait_impl_list   = crate.m_trait_impls[p].get_list_for_type_mut(ptr->m_type);
             trait_impl_list.push_back(mv$(ptr));
+            crate.m_trait_impl_cache.clear();
             };
         for(auto& impl : this->impls_closure)
         {
@@ -1226,6 +1227,7 @@ namespace {
                     /*source module*/::HIR::SimplePath(m_resolve.m_crate.m_crate_name, {})
                     }));
                 const_cast<::HIR::Crate&>(m_resolve.m_crate).m_all_trait_impls[lang_Copy].get_list_for_type_mut(closure_type).push_back( v.back().get() );
+                m_resolve.m_crate.m_trait_impl_cache.clear();
             }
 
             // ---
@@ -1954,6 +1956,7 @@ void HIR_Expand_Closures_Expr(const ::HIR::Crate& crate_ro, ::HIR::TypeRef& exp_
         closure_count += 1;
         auto boxed = box$(( ::HIR::VisEnt< ::HIR::TypeItem> { ::HIR::Publicity::new_none(), ::HIR::TypeItem( mv$(s) ) } ));
         auto* ret_ptr = &boxed->ent;
+        ::std::lock_guard<::std::mutex> lh { ::HIR::Crate::new_items_lock() };
         crate.m_new_types.push_back( ::std::make_pair(name, mv$(boxed)) );
         return ::std::make_pair( ::HIR::SimplePath(crate.m_crate_name, {}) + name, ret_ptr );
         };
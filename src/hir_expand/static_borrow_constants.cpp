@@ -1349,6 +1349,7 @@ void HIR_Expand_StaticBorrowConstants_Expr(const ::HIR::Crate& crate, const ::HI
                 new_static.m_value_generated = true;
                 new_static.m_value_res = ::std::move(value);
                 DEBUG(path << " = " << new_static.m_value_res);
+                ::std::lock_guard<::std::mutex> lh { ::HIR::Crate::new_items_lock() };
                 crate.m_new_values.push_back(std::make_pair( name, box$(HIR::VisEnt<HIR::ValueItem> {
                     HIR::Publicity::new_none(), // Should really be private, but we're well after checking
                     HIR::ValueItem(::std::move(new_static))
@@ -1373,8 +1374,9 @@ void HIR_Expand_StaticBorrowConstants_Expr(const ::HIR::Crate& crate, const ::HI
             : HIR::ValueItem(std::move(new_static))
             ;
         auto boxed = box$(( ::HIR::VisEnt< ::HIR::ValueItem> { ::HIR::Publicity::new_none(), std::move(vi) } ));
-        crate.m_new_values.push_back( ::std::make_pair(name, mv$(boxed)) );
         {
+            ::std::lock_guard<::std::mutex> lh { ::HIR::Crate::new_items_lock() };
+            crate.m_new_values.push_back( ::std::make_pair(name, mv$(boxed)) );
             auto& s = crate.m_new_values.back().second->ent.as_Static();
             s.m_value.m_state->m_impl_generics = nullptr;
             s.m_value.m_state->m_item_generics = &s.m_params;
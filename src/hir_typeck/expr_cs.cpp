@@ -16,6 +16,7 @@
 #include "expr_visit.hpp"
 #include "expr_cs.hpp"
 #include "hir_conv/main_bindings.hpp"
+#include <item_profile.hpp>
 
 namespace {
     inline HIR::ExprNodeP mk_exprnodep(HIR::ExprNode* en, ::HIR::TypeRef ty){ en->m_res_type = mv$(ty); return HIR::ExprNodeP(en); }
@@ -1930,6 +1931,33 @@ namespace {
 }
 
 
+bool Context::rule_is_waiting(const RuleWaitSet& ws) const
+{
+    if( !ws.is_set )
+        return false;
+    if( m_ivars.values_changed_since(ws.stamp) )
+        return false;
+    for(auto idx : ws.ivars)
+    {
+        if( m_ivars.ivar_changed_since(idx, ws.stamp) )
+            return false;
+    }
+    return true;
+}
+void Context::rule_set_waiting(RuleWaitSet& ws, unsigned int stamp, ::std::initializer_list<const ::HIR::TypeRef*> tys, const ::HIR::PathParams* pp) const
+{
+    ws.is_set = true;
+    ws.stamp = stamp;
+    ws.ivars.clear();
+    for(const auto* ty : tys)
+        m_ivars.list_unbound_ivars(*ty, ws.ivars);
+    if( pp )
+    {
+        for(const auto& ty : pp->m_types)
+            m_ivars.list_unbound_ivars(ty, ws.ivars);
+    }
+}
+
 void Context::dump() const {
     DEBUG("--- Variables");
     for(unsigned int i = 0; i < m_bindings.size(); i ++)
@@ -7788,6 +7816,94 @@ namespace
 
 
 
+/// Check coercion and associated type rules
+/// - If `only_woken` is set, rules that are still waiting on unchanged ivars are skipped
+void Typecheck_Code_CS__CheckRules(Context& context, bool only_woken)
+{
+    unsigned n_checked = 0;
+    unsigned n_skipped = 0;
+    DEBUG("--- Coercion checking");
+    for(size_t i = 0; i < context.link_coerce.size(); )
+    {
+        if( only_woken && context.rule_is_waiting(context.link_coerce[i]->wait) )
+        {
+            n_skipped ++;
+            ++ i;
+            continue ;
+        }
+        n_checked ++;
+        auto stamp = context.m_ivars.change_stamp();
+        auto ent = mv$(context.link_coerce[i]);
+        const auto& span = (*ent->right_node_ptr)->span();
+        auto& src_ty = (*ent->right_node_ptr)->m_res_type;
+        src_ty = context.m_resolve.expand_associated_types( span, mv$(src_ty) );    // TODO: This was commented, why?
+        ent->left_ty = context.m_resolve.expand_associated_types( span, mv$(ent->left_ty) );
+        if( check_coerce(context, *ent) )
+        {
+            DEBUG("- Consumed coercion R" << ent->rule_idx << " " << ent->left_ty << " := " << src_ty);
+
+            context.link_coerce.erase( context.link_coerce.begin() + i );
+        }
+        else
+        {
+            context.rule_set_waiting(ent->wait, stamp, { &ent->left_ty, &src_ty });
+            context.link_coerce[i] = mv$(ent);
+            ++ i;
+        }
+    }
+    // 3. Check associated type rules
+    DEBUG("--- Associated types");
+    unsigned int link_assoc_iter_limit = context.link_assoc.size() * 4;
+    for(unsigned int i = 0; i < context.link_assoc.size(); ) {
+        if( only_woken && context.rule_is_waiting(context.link_assoc[i].wait) )
+        {
+            n_skipped ++;
+            i ++;
+            continue ;
+        }
+        n_checked ++;
+        auto stamp = context.m_ivars.change_stamp();
+        // - Move out (and back in later) to avoid holding a bad pointer if the list is updated
+        auto rule = mv$(context.link_assoc[i]);
+
+        DEBUG("- " << rule);
+        for( auto& ty : rule.params.m_types ) {
+            ty = context.m_resolve.expand_associated_types(rule.span, mv$(ty));
+        }
+        if( rule.name != "" ) {
+            rule.left_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.left_ty));
+            // HACK: If the left type is `!`, remove the type bound
+            //if( rule.left_ty.data().is_Diverge() ) {
+            //    rule.name = "";
+            //}
+        }
+        rule.impl_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.impl_ty));
+
+        if( check_associated(context, rule) ) {
+            DEBUG("- Consumed associated type rule " << i << "/" << context.link_assoc.size() << " - " << rule);
+            if( i != context.link_assoc.size()-1 )
+            {
+                //assert( context.link_assoc[i] != context.link_assoc.back() );
+                context.link_assoc[i] = mv$( context.link_assoc.back() );
+            }
+            context.link_assoc.pop_back();
+        }
+        else {
+            context.rule_set_waiting(rule.wait, stamp, { &rule.left_ty, &rule.impl_ty }, &rule.params);
+            context.link_assoc[i] = mv$(rule);
+            i ++;
+        }
+
+        if( link_assoc_iter_limit -- == 0 )
+        {
+            DEBUG("link_assoc iteration limit exceeded");
+            break;
+        }
+    }
+    item_profile_count("rule_checks", n_checked);
+    item_profile_count("rule_skips", n_skipped);
+}
+
 void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr)
 {
     TRACE_FUNCTION;
@@ -7798,6 +7914,7 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
 
     // - Build up ruleset from node tree
     Typecheck_Code_CS__EnumerateRules(context, ms, args, result_type, expr, root_ptr);
+    item_profile_count("rules", context.link_coerce.size() + context.link_assoc.size() + context.to_visit.size() + context.adv_revisits.size());
 
     const unsigned int MAX_ITERATIONS = 1000;
     unsigned int count = 0;
@@ -7811,65 +7928,18 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         // - Keep a list in the ivar of what types that ivar could be equated to.
         if( ! context.m_ivars.peek_changed() )
         {
-            DEBUG("--- Coercion checking");
-            for(size_t i = 0; i < context.link_coerce.size(); )
+            // Only check rules that have been woken by a change to an ivar they were waiting on
+            Typecheck_Code_CS__CheckRules(context, /*only_woken=*/true);
+            // If that made no progress, the ivar possibilities are about to be used - so re-check everything to get the
+            // full set (and to catch anything that depends on more than just the ivars)
+            if( ! context.m_ivars.peek_changed() )
             {
-                auto ent = mv$(context.link_coerce[i]);
-                const auto& span = (*ent->right_node_ptr)->span();
-                auto& src_ty = (*ent->right_node_ptr)->m_res_type;
-                src_ty = context.m_resolve.expand_associated_types( span, mv$(src_ty) );    // TODO: This was commented, why?
-                ent->left_ty = context.m_resolve.expand_associated_types( span, mv$(ent->left_ty) );
-                if( check_coerce(context, *ent) )
-                {
-                    DEBUG("- Consumed coercion R" << ent->rule_idx << " " << ent->left_ty << " := " << src_ty);
-
-                    context.link_coerce.erase( context.link_coerce.begin() + i );
-                }
-                else
+                DEBUG("--- No change from woken rules, checking all");
+                for(auto& ivar_ent : context.possible_ivar_vals)
                 {
-                    context.link_coerce[i] = mv$(ent);
-                    ++ i;
-                }
-            }
-            // 3. Check associated type rules
-            DEBUG("--- Associated types");
-            unsigned int link_assoc_iter_limit = context.link_assoc.size() * 4;
-            for(unsigned int i = 0; i < context.link_assoc.size(); ) {
-                // - Move out (and back in later) to avoid holding a bad pointer if the list is updated
-                auto rule = mv$(context.link_assoc[i]);
-
-                DEBUG("- " << rule);
-                for( auto& ty : rule.params.m_types ) {
-                    ty = context.m_resolve.expand_associated_types(rule.span, mv$(ty));
-                }
-                if( rule.name != "" ) {
-                    rule.left_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.left_ty));
-                    // HACK: If the left type is `!`, remove the type bound
-                    //if( rule.left_ty.data().is_Diverge() ) {
-                    //    rule.name = "";
-                    //}
-                }
-                rule.impl_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.impl_ty));
-
-                if( check_associated(context, rule) ) {
-                    DEBUG("- Consumed associated type rule " << i << "/" << context.link_assoc.size() << " - " << rule);
-                    if( i != context.link_assoc.size()-1 )
-                    {
-                        //assert( context.link_assoc[i] != context.link_assoc.back() );
-                        context.link_assoc[i] = mv$( context.link_assoc.back() );
-                    }
-                    context.link_assoc.pop_back();
-                }
-                else {
-                    context.link_assoc[i] = mv$(rule);
-                    i ++;
-                }
-
-                if( link_assoc_iter_limit -- == 0 )
-                {
-                    DEBUG("link_assoc iteration limit exceeded");
-                    break;
+                    ivar_ent.reset();
                 }
+                Typecheck_Code_CS__CheckRules(context, /*only_woken=*/false);
             }
         }
         // 4. Revisit nodes that require revisiting
@@ -8150,6 +8220,7 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
     if( count == MAX_ITERATIONS ) {
         BUG(root_ptr->span(), "Typecheck ran for too many iterations, max - " << MAX_ITERATIONS);
     }
+    item_profile_count("solver_passes", count);
 
     if( context.has_rules() )
     {
@@ -32,6 +32,15 @@ struct Context
         //unsigned int ivar;
     };
 
+    /// Record of the ivars that a rule was waiting on when it was last checked
+    /// - The rule isn't re-checked until one of these changes (or the solver stalls)
+    struct RuleWaitSet
+    {
+        bool    is_set = false;
+        unsigned int    stamp = 0;
+        ::std::vector<unsigned int> ivars;
+    };
+
     /// Inferrence variable equalities
     struct Coercion
     {
@@ -39,6 +48,8 @@ struct Context
         ::HIR::TypeRef  left_ty;
         ::HIR::ExprNodeP* right_node_ptr;
 
+        RuleWaitSet wait;
+
         friend ::std::ostream& operator<<(::std::ostream& os, const Coercion& v) {
             os << "R" << v.rule_idx << " " << v.left_ty << " := " << v.right_node_ptr << " " << &**v.right_node_ptr << " (" << (*v.right_node_ptr)->m_res_type << ")";
             return os;
@@ -58,6 +69,8 @@ struct Context
                             // HACK: operators are special - the result when both types are primitives is ALWAYS the lefthand side
         bool    is_operator;
 
+        RuleWaitSet wait;
+
         friend ::std::ostream& operator<<(::std::ostream& os, const Associated& v) {
             os << "R" << v.rule_idx << " ";
             if( v.name == "" ) {
@@ -193,6 +206,11 @@ struct Context
     void dump() const;
 
     bool take_changed() { return m_ivars.take_changed(); }
+
+    /// Returns true if none of the ivars the rule was waiting on have changed since it was last checked
+    bool rule_is_waiting(const RuleWaitSet& ws) const;
+    /// Update the wait set for a rule that could not be consumed (`stamp` is the change stamp from before the check)
+    void rule_set_waiting(RuleWaitSet& ws, unsigned int stamp, ::std::initializer_list<const ::HIR::TypeRef*> tys, const ::HIR::PathParams* pp=nullptr) const;
     bool has_rules() const {
         return !(link_coerce.empty() && link_assoc.empty() && to_visit.empty() && adv_revisits.empty());
     }
@@ -10,6 +10,9 @@
 #include <hir/visitor.hpp>
 #include "expr_visit.hpp"
 #include <hir/expr_state.hpp>
+#include <hir_conv/main_bindings.hpp>   // ConvertHIR_ConstantEvaluate_*
+#include <item_profile.hpp>
+#include <parallel.hpp>
 
 void Typecheck_Code(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
     if( expr.m_state->stage < ::HIR::ExprState::Stage::Typecheck )
@@ -106,18 +109,36 @@ namespace typeck {
 
 namespace {
 
+    /// A function body collected for checking after the visit (see `Typecheck_Expressions`)
+    struct DeferredBody
+    {
+        ::typeck::ModuleState   ms;
+        /// Owned copy of the current trait path (the visitor's is on the stack)
+        ::std::unique_ptr<::HIR::GenericPath>   current_trait;
+        ::std::string   name;
+        t_args* args;
+        const ::HIR::TypeRef*   ret;
+        ::HIR::ExprPtr* code;
+    };
 
     class OuterVisitor:
         public ::HIR::Visitor
     {
         ::typeck::ModuleState m_ms;
+        ::std::vector<DeferredBody>*    m_deferred;
     public:
-        OuterVisitor(::HIR::Crate& crate):
-            m_ms(crate)
+        OuterVisitor(::HIR::Crate& crate, ::std::vector<DeferredBody>* deferred=nullptr):
+            m_ms(crate),
+            m_deferred(deferred)
         {
         }
 
 
+    private:
+        ::HIR::SimplePath cur_mod_path() const {
+            return m_ms.m_mod_paths.empty() ? ::HIR::SimplePath(m_ms.m_crate.m_crate_name, {}) : m_ms.m_mod_paths.back();
+        }
+
     public:
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
         {
@@ -186,6 +207,7 @@ namespace {
 
         void visit_type(::HIR::TypeRef& ty) override
         {
+            static Span sp;
             if(auto* e = ty.data_mut().opt_Array())
             {
                 this->visit_type( e->inner );
@@ -196,9 +218,24 @@ namespace {
                         Typecheck_Code( m_ms, tmp, ::HIR::TypeRef(::HIR::CoreType::Usize), *se->as_Unevaluated()->expr );
                     }
                 }
+                // Deferred bodies would evaluate this on demand, writing to a type shared between workers
+                if( m_deferred ) {
+                    ConvertHIR_ConstantEvaluate_ArraySize(sp, m_ms.m_crate, cur_mod_path(), e->size);
+                }
             }
             else {
                 ::HIR::Visitor::visit_type(ty);
+                // Same for value generics (evaluated by `expand_associated_types`)
+                if( m_deferred )
+                {
+                    if( auto* e = ty.data_mut().opt_Path() ) {
+                        const auto* params_def = e->binding.get_generics();
+                        if( e->path.m_data.is_Generic() && params_def ) {
+                            ConvertHIR_ConstantEvaluate_MethodParams(sp, m_ms.m_crate, cur_mod_path(), m_ms.m_impl_generics, m_ms.m_item_generics,
+                                *params_def, e->path.m_data.as_Generic().m_params);
+                        }
+                    }
+                }
             }
         }
         // ------
@@ -206,9 +243,29 @@ namespace {
         // ------
         void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
             auto _ = this->m_ms.set_item_generics(item.m_params);
+            if( m_deferred )
+            {
+                // Evaluate the signature's array sizes before the bodies are checked in parallel
+                for(auto& arg : item.m_args)
+                    this->visit_type(arg.second);
+                this->visit_type(item.m_return);
+            }
             if( item.m_code )
             {
+                // NOTE: `const fn`s are always checked in visit order, as constant evaluation can request them
+                if( m_deferred && !item.m_const && item.m_code.m_state->stage < ::HIR::ExprState::Stage::Typecheck )
+                {
+                    DEBUG("Function code " << p << " (deferred)");
+                    DeferredBody    b { m_ms, nullptr, g_item_profile_enabled ? FMT(p) : ::std::string(), &item.m_args, &item.m_return, &item.m_code };
+                    if( m_ms.m_current_trait ) {
+                        b.current_trait.reset(new ::HIR::GenericPath(m_ms.m_current_trait->clone()));
+                        b.ms.m_current_trait = b.current_trait.get();
+                    }
+                    m_deferred->push_back(mv$(b));
+                    return ;
+                }
                 DEBUG("Function code " << p);
+                ItemProfileScope    profile("Typecheck", p);
                 Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
             }
             else
@@ -218,6 +275,9 @@ namespace {
         }
         void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
             //auto _ = this->m_ms.set_item_generics(item.m_params);
+            if( m_deferred ) {
+                this->visit_type(item.m_type);
+            }
             if( item.m_value )
             {
                 DEBUG("Static value " << p);
@@ -227,6 +287,9 @@ namespace {
         }
         void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
             auto _ = this->m_ms.set_item_generics(item.m_params);
+            if( m_deferred ) {
+                this->visit_type(item.m_type);
+            }
             if( item.m_value )
             {
                 DEBUG("Const value " << p);
@@ -237,6 +300,13 @@ namespace {
         void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
             auto _ = this->m_ms.set_item_generics(item.m_params);
 
+            if( auto* e = item.m_data.opt_Data() )
+            {
+                if( m_deferred ) {
+                    for(auto& var : *e)
+                        this->visit_type(var.type);
+                }
+            }
             if( auto* e = item.m_data.opt_Value() )
             {
                 auto enum_type = ::HIR::Enum::get_repr_type(item.m_tag_repr);
@@ -257,6 +327,16 @@ namespace {
 
 void Typecheck_Expressions(::HIR::Crate& crate)
 {
-    OuterVisitor    visitor { crate };
+    // With `-Z threads`, function bodies are collected and then checked in parallel
+    // - Bodies are independent once the outer types are known, each only writes to its own expression tree
+    // - The visit also evaluates array sizes/value generics in item types, as workers share (and would otherwise write to) them
+    ::std::vector<DeferredBody> deferred;
+    OuterVisitor    visitor { crate, g_parallel_threads > 1 ? &deferred : nullptr };
     visitor.visit_crate( crate );
+
+    Parallel_ForEach(deferred.size(), [](){ return 0; }, [&](int& , size_t i) {
+        auto& b = deferred[i];
+        ItemProfileScope    profile("Typecheck", b.name);
+        Typecheck_Code( b.ms, *b.args, *b.ret, *b.code );
+        });
 }
@@ -8,6 +8,7 @@
 #include "helpers.hpp"
 #include <hir_conv/main_bindings.hpp>
 #include <algorithm>
+#include <mutex>
 
 // --------------------------------------------------------------------
 // HMTypeInferrence
@@ -240,11 +241,13 @@ bool HMTypeInferrence::apply_defaults()
                     rv = true;
                     DEBUG("- IVar " << e->index << " = i32");
                     *v.type = ::HIR::TypeRef( ::HIR::CoreType::I32 );
+                    v.change_stamp = ++m_change_stamp;
                     break;
                 case ::HIR::InferClass::Float:
                     rv = true;
                     DEBUG("- IVar " << e->index << " = f64");
                     *v.type = ::HIR::TypeRef( ::HIR::CoreType::F64 );
+                    v.change_stamp = ++m_change_stamp;
                     break;
                 }
             }
@@ -697,6 +700,7 @@ void HMTypeInferrence::set_ivar_val_to(unsigned int slot, ::HIR::ConstGeneric va
         ASSERT_BUG(Span(), m_values[slot].val->is_Infer(), "slot " << slot << " - " << *m_values[slot].val);
         ASSERT_BUG(Span(), m_values[slot].val->as_Infer().index == slot, "slot " << slot << " - " << *m_values[slot].val);
         *m_values[slot].val = std::move(val);
+        m_value_change_stamp = ++m_change_stamp;
     }
 }
 void HMTypeInferrence::ivar_val_unify(unsigned int left_slot, unsigned int right_slot)
@@ -712,6 +716,7 @@ void HMTypeInferrence::ivar_val_unify(unsigned int left_slot, unsigned int right
         DEBUG("Set ValIVar " << right_slot << " = @" << left_slot);
         m_values[right_slot].alias = left_slot;
         m_values[right_slot].val.reset();
+        m_value_change_stamp = ++m_change_stamp;
 
         this->mark_change();
     }
@@ -786,6 +791,7 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
         auto& r_ivar = this->get_pointed_ivar(l_e->index);
         r_ivar.alias = slot;
         r_ivar.type.reset();
+        r_ivar.change_stamp = ++m_change_stamp;
         #else
         DEBUG("Set IVar " << slot << " = @" << l_e->index);
         root_ivar.alias = l_e->index;
@@ -860,6 +866,7 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
         }
 
         root_ivar.type = box$( type );
+        root_ivar.change_stamp = ++m_change_stamp;
     }
 
     this->mark_change();
@@ -911,6 +918,7 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
         DEBUG("IVar " << root_ivar.type->data().as_Infer().index << " = @" << left_slot);
         root_ivar.alias = left_slot;
         root_ivar.type.reset();
+        root_ivar.change_stamp = ++m_change_stamp;
 
         this->mark_change();
     }
@@ -947,6 +955,40 @@ const ::HIR::ConstGeneric& HMTypeInferrence::get_value(unsigned slot) const
 }
 
 
+void HMTypeInferrence::touch_ivar(unsigned int slot)
+{
+    get_pointed_ivar(slot).change_stamp = ++m_change_stamp;
+}
+void HMTypeInferrence::list_unbound_ivars(const ::HIR::TypeRef& ty, ::std::vector<unsigned int>& out) const
+{
+    visit_ty_with(ty, [&](const ::HIR::TypeRef& t) {
+        if( t.data().is_Infer() ) {
+            const auto& rt = this->get_type(t);
+            if( const auto* e = rt.data().opt_Infer() ) {
+                out.push_back(e->index);
+            }
+            else {
+                this->list_unbound_ivars(rt, out);
+            }
+        }
+        return false;
+        });
+}
+bool HMTypeInferrence::ivar_changed_since(unsigned int slot, unsigned int stamp) const
+{
+    // Walk the alias chain, an ivar being aliased counts as a change to it.
+    auto index = slot;
+    unsigned int count = 0;
+    assert(index < m_ivars.size());
+    while( m_ivars[index].change_stamp <= stamp ) {
+        if( !m_ivars[index].is_alias() )
+            return false;
+        index = m_ivars[index].alias;
+        ASSERT_BUG(Span(), count++ < m_ivars.size(), "Loop detected in ivar list when starting at " << slot);
+    }
+    return true;
+}
+
 HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot) const
 {
     auto index = slot;
@@ -1975,6 +2017,9 @@ void TraitResolution::compact_ivars(HMTypeInferrence& m_ivars)
                 // TODO: cloning is expensive, BUT printing below is nice
                 auto nt = this->expand_associated_types(Span(), v.type->clone());
                 DEBUG("- " << i << " " << *v.type << " -> " << nt);
+                if( nt != *v.type ) {
+                    m_ivars.touch_ivar(i);
+                }
                 *v.type = mv$(nt);
             }
         }
@@ -2971,6 +3016,10 @@ bool TraitResolution::find_trait_impls_bound(const Span& sp, const ::HIR::Simple
     }
     return false;
 }
+namespace {
+    /// Guards the (mutable) auto trait cache in `HIR::TraitMarkings`, which is filled during parallel typecheck
+    ::std::mutex    s_auto_impls_lock;
+}
 bool TraitResolution::find_trait_impls_crate(const Span& sp,
         const ::HIR::SimplePath& trait, const ::HIR::PathParams* params_ptr,
         const ::HIR::TypeRef& type,
@@ -3012,7 +3061,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         StackHandle& operator=(const StackHandle&) = delete;
         ~StackHandle() { if(stack) stack->pop_back(); stack = nullptr; }
     };
-    static std::vector<StackEnt>    s_recurse_stack;
+    thread_local static std::vector<StackEnt>    s_recurse_stack;
     auto se = StackEnt(trait, params_ptr, type);
     // NOTE: Allow 1 level of recursion (EAT being run)
     if( std::count(s_recurse_stack.begin(), s_recurse_stack.end(), se) > 1 ) {
@@ -3026,7 +3075,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     if( m_crate.get_trait_by_path(sp, trait).m_is_marker )
     {
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        thread_local static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait )
                 continue ;
@@ -3062,13 +3111,20 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         // - Cache populated after destructure
         if( markings )
         {
-            auto it = markings->auto_impls.find( trait );
-            if( it != markings->auto_impls.end() )
+            // NOTE: Entries are never updated once inserted, so the lock is only needed for the lookup
+            const ::HIR::TraitMarkings::AutoMarking* cached = nullptr;
+            {
+                ::std::lock_guard<::std::mutex> lh { s_auto_impls_lock };
+                auto it = markings->auto_impls.find( trait );
+                if( it != markings->auto_impls.end() )
+                    cached = &it->second;
+            }
+            if( cached )
             {
-                if( ! it->second.conditions.empty() ) {
+                if( ! cached->conditions.empty() ) {
                     TODO(sp, "Conditional auto trait impl");
                 }
-                else if( it->second.is_impled ) {
+                else if( cached->is_impled ) {
                     return callback( ImplRef(nullptr, &type, params_ptr, &null_assoc), ::HIR::Compare::Equal );
                 }
                 else {
@@ -3142,6 +3198,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         {
             if( markings ) {
                 ASSERT_BUG(sp, cmp == ::HIR::Compare::Equal, "Auto trait with no params returned a fuzzy match from destructure - " << trait << " for " << type);
+                ::std::lock_guard<::std::mutex> lh { s_auto_impls_lock };
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, true }) );
             }
             return callback( ImplRef(nullptr, &type, params_ptr, &null_assoc), cmp );
@@ -3149,6 +3206,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         else
         {
             if( markings ) {
+                ::std::lock_guard<::std::mutex> lh { s_auto_impls_lock };
                 markings->auto_impls.insert( ::std::make_pair(trait, ::HIR::TraitMarkings::AutoMarking { {}, false }) );
             }
             return false;
@@ -3172,22 +3230,31 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     }
 #endif
 
-    return this->m_crate.find_trait_impls(trait, type, this->m_ivars.callback_resolve_infer(),
-        [&](const auto& impl) {
-            DEBUG("[find_trait_impls_crate] Found impl" << impl.m_params.fmt_args() << " " << trait << impl.m_trait_args << " for " << impl.m_type << " " << impl.m_params.fmt_bounds());
-            // Compare with `params`
-            HIR::PathParams impl_params;
-            auto match = this->ftic_check_params(sp, trait,  params_ptr, type,  impl.m_params, impl.m_trait_args, impl.m_type,  impl_params);
-            if( match == ::HIR::Compare::Unequal ) {
-                // If any bound failed, return false (continue searching)
-                DEBUG("[find_trait_impls_crate] - Params mismatch");
-                return false;
-            }
-            DEBUG("[find_trait_impls_crate] - Found with impl_params=" << impl_params);
-
-            return callback(ImplRef(mv$(impl_params), m_crate.get_trait_by_path(sp, trait), trait, impl), match);
+    auto check_impl = [&](const ::HIR::TraitImpl& impl) {
+        DEBUG("[find_trait_impls_crate] Found impl" << impl.m_params.fmt_args() << " " << trait << impl.m_trait_args << " for " << impl.m_type << " " << impl.m_params.fmt_bounds());
+        // Compare with `params`
+        HIR::PathParams impl_params;
+        auto match = this->ftic_check_params(sp, trait,  params_ptr, type,  impl.m_params, impl.m_trait_args, impl.m_type,  impl_params);
+        if( match == ::HIR::Compare::Unequal ) {
+            // If any bound failed, return false (continue searching)
+            DEBUG("[find_trait_impls_crate] - Params mismatch");
+            return false;
         }
-        );
+        DEBUG("[find_trait_impls_crate] - Found with impl_params=" << impl_params);
+
+        return callback(ImplRef(mv$(impl_params), m_crate.get_trait_by_path(sp, trait), trait, impl), match);
+        };
+    // Fully-known queries can use the crate-wide cache (and only check the impls that matched last time)
+    auto* cached_impls = m_crate.m_trait_impl_cache.get(m_crate, ::HIR::TraitImplCache::Resolver::Typeck, trait, params_ptr, type,
+        [&](const ::HIR::TraitImpl& impl) {
+            HIR::PathParams impl_params;
+            return this->ftic_check_params(sp, trait,  params_ptr, type,  impl.m_params, impl.m_trait_args, impl.m_type,  impl_params) != ::HIR::Compare::Unequal;
+        });
+    if( cached_impls )
+    {
+        return ::std::any_of(cached_impls->begin(), cached_impls->end(), [&](const ::HIR::TraitImpl* impl){ return check_impl(*impl); });
+    }
+    return this->m_crate.find_trait_impls(trait, type, this->m_ivars.callback_resolve_infer(), check_impl);
 }
 
 ::HIR::Compare TraitResolution::check_auto_trait_impl_destructure(const Span& sp, const ::HIR::SimplePath& trait, const ::HIR::PathParams* params_ptr, const ::HIR::TypeRef& type) const
@@ -60,10 +60,12 @@ public: // ?? - Needed once, anymore?
         //bool could_be_diverge;
         unsigned int alias; // If not ~0, this points to another ivar
         ::std::unique_ptr< ::HIR::TypeRef> type;    // Type (only nullptr if alias!=0)
+        unsigned int change_stamp;  // Value of `m_change_stamp` when this ivar was last assigned/aliased
 
         IVar():
             alias(~0u),
-            type(new ::HIR::TypeRef())
+            type(new ::HIR::TypeRef()),
+            change_stamp(0)
         {}
         bool is_alias() const { return alias != ~0u; }
     };
@@ -81,10 +83,16 @@ public: // ?? - Needed once, anymore?
     ::std::vector< IVarValue>    m_values;
 
     bool    m_has_changed;
+    /// Incremented on every ivar assignment, used to wake rules that are waiting on specific ivars
+    unsigned int    m_change_stamp;
+    /// Stamp of the last value ivar change (value ivars aren't tracked individually)
+    unsigned int    m_value_change_stamp;
 
 public:
     HMTypeInferrence():
-        m_has_changed(false)
+        m_has_changed(false),
+        m_change_stamp(0),
+        m_value_change_stamp(0)
     {}
 
     bool peek_changed() const {
@@ -105,6 +113,19 @@ public:
     void compact_ivars();
     bool apply_defaults();
 
+    unsigned int change_stamp() const {
+        return m_change_stamp;
+    }
+    /// Record that the (root) ivar `slot` has been changed by something other than `set_ivar_to`/`ivar_unify`
+    void touch_ivar(unsigned int slot);
+    /// Append the indexes of all unbound (root) ivars referenced by `ty` to `out`
+    void list_unbound_ivars(const ::HIR::TypeRef& ty, ::std::vector<unsigned int>& out) const;
+    /// Returns true if the ivar `slot` (or anything it now aliases) has changed since `stamp`
+    bool ivar_changed_since(unsigned int slot, unsigned int stamp) const;
+    bool values_changed_since(unsigned int stamp) const {
+        return m_value_change_stamp > stamp;
+    }
+
     void dump() const;
 
     void print_type(::std::ostream& os, const ::HIR::TypeRef& tr, LList<const ::HIR::TypeRef*> stack = {}) const;
@@ -77,30 +77,35 @@ bool StaticTraitResolve::find_impl(
             }
             else {
             }
-            static ::HIR::TraitPath::assoc_list_t   assoc_unit;
-            if(assoc_unit.empty()) {
-                assoc_unit.insert(std::make_pair( RcString::new_interned("Discriminant"), HIR::TraitPath::AtyEqual {
+            // NOTE: Function-local static initialisation is thread-safe (and the lang item is the same for every resolver)
+            static const ::HIR::TraitPath::assoc_list_t   assoc_unit = [&](){
+                ::HIR::TraitPath::assoc_list_t  rv;
+                rv.insert(std::make_pair( RcString::new_interned("Discriminant"), HIR::TraitPath::AtyEqual {
                     m_lang_DiscriminantKind,
                     HIR::TypeRef::new_unit()
                     } ));
-            }
+                return rv;
+                }();
             return found_cb( ImplRef(&null_hrls, &type, trait_params, &assoc_unit), false );
         }
         else if( TARGETVER_LEAST_1_54 && trait_path == m_lang_Pointee ) {
-            static ::HIR::TraitPath::assoc_list_t   assoc_unit;
-            static ::HIR::TraitPath::assoc_list_t   assoc_slice;
-            static RcString name_Metadata;
-            if(assoc_unit.empty()) {
-                name_Metadata = RcString::new_interned("Metadata");
-                assoc_unit.insert(std::make_pair( name_Metadata, HIR::TraitPath::AtyEqual {
+            static const RcString name_Metadata = RcString::new_interned("Metadata");
+            static const ::HIR::TraitPath::assoc_list_t   assoc_unit = [&](){
+                ::HIR::TraitPath::assoc_list_t  rv;
+                rv.insert(std::make_pair( name_Metadata, HIR::TraitPath::AtyEqual {
                     m_lang_Pointee,
                     HIR::TypeRef::new_unit()
                     } ));
-                assoc_slice.insert(std::make_pair( name_Metadata, HIR::TraitPath::AtyEqual {
+                return rv;
+                }();
+            static const ::HIR::TraitPath::assoc_list_t   assoc_slice = [&](){
+                ::HIR::TraitPath::assoc_list_t  rv;
+                rv.insert(std::make_pair( name_Metadata, HIR::TraitPath::AtyEqual {
                     m_lang_Pointee,
                     HIR::CoreType::Usize
                     } ));
-            }
+                return rv;
+                }();
 
             // Generics (or opaque ATYs)
             if( type.data().is_Generic() || (type.data().is_Path() && type.data().as_Path().binding.is_Opaque()) ) {
@@ -636,7 +641,7 @@ bool StaticTraitResolve::find_impl(
             return rv;
 
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        thread_local static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait_path )
                 continue ;
@@ -661,9 +666,21 @@ bool StaticTraitResolve::find_impl(
     {
         // Search the crate for impls
         DEBUG("Search for " << trait_path << " for " << type);
-        ret = m_crate.find_trait_impls(trait_path, type, cb_ident, [&](const auto& impl) {
+        auto check_impl = [&](const ::HIR::TraitImpl& impl) {
             return this->find_impl__check_crate(sp, trait_path, trait_params, type, found_cb,  impl);
+            };
+        auto* cached_impls = m_crate.m_trait_impl_cache.get(m_crate, ::HIR::TraitImplCache::Resolver::Static, trait_path, trait_params, type,
+            [&](const ::HIR::TraitImpl& impl) {
+                return this->find_impl__check_crate(sp, trait_path, trait_params, type, [](ImplRef, bool){ return true; },  impl);
             });
+        if( cached_impls )
+        {
+            ret = ::std::any_of(cached_impls->begin(), cached_impls->end(), [&](const ::HIR::TraitImpl* impl){ return check_impl(*impl); });
+        }
+        else
+        {
+            ret = m_crate.find_trait_impls(trait_path, type, cb_ident, check_impl);
+        }
         if(ret)
             return true;
     }
@@ -1635,12 +1652,12 @@ bool StaticTraitResolve::expand_associated_types__UfcsKnown(const Span& sp, ::HI
     auto& e = input.data_mut().as_Path();
     auto& e2 = e.path.m_data.as_UfcsKnown();
 
-    static unsigned s_recursion_level;
+    thread_local static unsigned s_recursion_level;
     struct RecurseEntry {
         HIR::TypeRef    ty;
         unsigned level;
     };
-    static std::vector<RecurseEntry>    s_recursion_stack;
+    thread_local static std::vector<RecurseEntry>    s_recursion_stack;
     {
         bool hit_same_level_loop = false;
         for(const auto& ent : s_recursion_stack) {
@@ -125,6 +125,9 @@ public:
         m_item_generics = nullptr;
         prep_indexes();
     }
+    MetadataType self_metadata() const {
+        return m_self_metadata;
+    }
     // Used by ResolveUFCS to regenerate
     void prep_indexes(const Span& sp) {
         TraitResolveCommon::prep_indexes(sp);
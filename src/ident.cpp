@@ -12,21 +12,57 @@
 
 unsigned int Ident::Hygiene::g_next_scope = 0;
 
+::std::vector<unsigned> Ident::Hygiene::contexts() const
+{
+    ::std::vector<unsigned> rv(this->depth());
+    size_t i = rv.size();
+    for(const auto* n = this->scope_node(); n; n = n->parent)
+        rv[--i] = n->index;
+    return rv;
+}
+Ident::Hygiene Ident::Hygiene::get_parent() const
+{
+    //assert(this->depth() > 0);
+    if( this->depth() <= 1 )
+        return Hygiene();
+    const auto* p = m_inner->parent;
+    if( !p->search_module ) {
+        p->refcount.fetch_add(1, ::std::memory_order_relaxed);
+        return Hygiene(p);
+    }
+    return Hygiene(make_node(p->depth, p->index, p->parent, nullptr));
+}
+void Ident::Hygiene::set_mod_path(ModPath p)
+{
+    auto mp = ::std::make_shared<const ModPath>(::std::move(p));
+    const Node* n = m_inner ? make_node(m_inner->depth, m_inner->index, m_inner->parent, ::std::move(mp)) : make_node(0, 0, nullptr, ::std::move(mp));
+    release(m_inner);
+    m_inner = n;
+}
+
 bool Ident::Hygiene::is_visible(const Hygiene& src) const
 {
     // HACK: Disable hygiene for now
     //return true;
 
-    if( m_inner->contexts.size() == 0 ) {
-        return src->contexts.size() == 0;
+    if( this->depth() == 0 ) {
+        return src.depth() == 0;
     }
 
-    auto des = m_inner->contexts.back();
-    for(const auto& c : src->contexts)
-        if( des == c )
+    auto des = m_inner->index;
+    for(const auto* n = src.scope_node(); n; n = n->parent)
+        if( des == n->index )
             return true;
     return false;
 }
+Ordering Ident::Hygiene::ord_slow(const Hygiene& x) const
+{
+    // Siblings (same parent chain) only differ in the last index
+    if( this->depth() == x.depth() && this->depth() > 0 && m_inner->parent == x.m_inner->parent )
+        return ::ord(m_inner->index, x.m_inner->index);
+    ORD(this->contexts(), x.contexts());
+    return OrdEqual;
+}
 
 ::std::ostream& operator<<(::std::ostream& os, const Ident& x) {
     os << x.name << x.hygiene;
@@ -34,9 +70,9 @@ bool Ident::Hygiene::is_visible(const Hygiene& src) const
 }
 
 ::std::ostream& operator<<(::std::ostream& os, const Ident::Hygiene& x) {
-    os << "/*" << x->contexts;
-    if( x->search_module )
-        os << " " << *x->search_module;
+    os << "/*" << x.contexts();
+    if( x.has_mod_path() )
+        os << " " << x.mod_path();
     os << "*/";
     return os;
 }
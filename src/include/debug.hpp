@@ -12,7 +12,9 @@
 #include <cassert>
 #include <functional>
 
-extern int g_debug_indent_level;
+extern thread_local int g_debug_indent_level;
+/// Cached result of the phase filter for the current phase (updated by `DebugTimedPhase`)
+extern bool g_debug_enabled;
 
 #ifndef DEBUG_EXTRA_ENABLE
 # define DEBUG_EXTRA_ENABLE  // Files can override this with their own flag if needed (e.g. `&& g_my_debug_on`)
@@ -26,8 +28,10 @@ extern int g_debug_indent_level;
 # define DEBUG(ss)   do{ if(DEBUG_ENABLED) { debug_output(g_debug_indent_level, __FUNCTION__) << ss << std::dec << ::std::endl; } } while(0)
 # define TRACE_FUNCTION  TraceLog _tf_( DEBUG_ENABLED ? __func__ : nullptr)
 # define TRACE_FUNCTION_F(ss)    TraceLog _tf_(DEBUG_ENABLED ? __func__ : nullptr, [&](::std::ostream&__os){ __os << ss; })
-# define TRACE_FUNCTION_FR(ss,ss2)    TraceLog _tf_(DEBUG_ENABLED ? __func__ : nullptr, [&](::std::ostream&__os){ __os << ss; }, [&](::std::ostream&__os){ __os << ss2;})
+// NOTE: The return formatter is a named local, as `TraceLog` only holds a reference to it
+# define TRACE_FUNCTION_FR(ss,ss2)    auto _tf_ret_ = [&](::std::ostream&__os){ __os << ss2;}; TraceLog _tf_(DEBUG_ENABLED ? __func__ : nullptr, [&](::std::ostream&__os){ __os << ss; }, _tf_ret_)
 #else
+# define DEBUG_ENABLED  false
 # define INDENT()    do { } while(0)
 # define UNINDENT()    do {} while(0)
 # define DEBUG(ss)   do{ if(false) (void)(::NullSink() << ss); } while(0)
@@ -36,7 +40,7 @@ extern int g_debug_indent_level;
 # define TRACE_FUNCTION_FR(ss,ss2)  do{ if(false) (void)(::NullSink() << ss); if(false) (void)(::NullSink() << ss2); } while(0)
 #endif
 
-extern bool debug_enabled();
+inline bool debug_enabled() { return g_debug_enabled; }
 extern ::std::ostream& debug_output(int indent, const char* function);
 
 struct RepeatLitStr
@@ -61,15 +65,55 @@ public:
     const NullSink& operator<<(const T&) const { return *this;  }
 };
 
+/// Scope guard for `TRACE_FUNCTION*`
+/// - The formatters are held by pointer (no `std::function`), and nothing beyond the indent is done when `tag` is null
 class TraceLog
 {
+    typedef void (*fmt_fcn_t)(const void* cb, ::std::ostream& os);
+
     const char* m_tag;
-    ::std::function<void(::std::ostream&)>  m_ret;
+    fmt_fcn_t   m_ret_fcn;
+    const void* m_ret_cb;
+
+    template<typename F>
+    static void call_fmt(const void* cb, ::std::ostream& os) {
+        (*static_cast<const F*>(cb))(os);
+    }
+    void open(fmt_fcn_t info_fcn, const void* info_cb);
+    void close();
 public:
-    TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb, ::std::function<void(::std::ostream&)> ret);
-    TraceLog(const char* tag, ::std::function<void(::std::ostream&)> info_cb);
-    TraceLog(const char* tag);
-    ~TraceLog();
+    TraceLog(const char* tag):
+        m_tag(tag),
+        m_ret_fcn(nullptr),
+        m_ret_cb(nullptr)
+    {
+        if(m_tag)   open(nullptr, nullptr);
+        INDENT();
+    }
+    template<typename F>
+    TraceLog(const char* tag, const F& info_cb):
+        m_tag(tag),
+        m_ret_fcn(nullptr),
+        m_ret_cb(nullptr)
+    {
+        if(m_tag)   open(&call_fmt<F>, &info_cb);
+        INDENT();
+    }
+    /// NOTE: `ret` must outlive this object
+    template<typename F, typename R>
+    TraceLog(const char* tag, const F& info_cb, const R& ret):
+        m_tag(tag),
+        m_ret_fcn(&call_fmt<R>),
+        m_ret_cb(&ret)
+    {
+        if(m_tag)   open(&call_fmt<F>, &info_cb);
+        INDENT();
+    }
+    TraceLog(const TraceLog&) = delete;
+    ~TraceLog() {
+        UNINDENT();
+        if(m_tag)   close();
+    }
 };
 
 struct FmtLambda
@@ -2,14 +2,47 @@
  */
 #pragma once
 #include <ctime>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <vector>
 #include <initializer_list>
 
 extern void debug_init_phases(const char* env_var_name, std::initializer_list<const char*> il);
+/// Enable machine-readable phase timing (`-Z time-passes=<path>`)
+/// - One JSON object per phase is written to `path`, and a Chrome `trace_event` file to `path`.trace.json
+extern void debug_timing_open(const char* path);
+/// Number of global `operator new` calls so far (see debug_alloc.cpp)
+extern uint64_t debug_alloc_count();
+
+/// Named event counter, reported (as the change over each phase) alongside phase timings
+/// - Intended for use as a namespace-scope static
+class DebugPhaseCounter
+{
+    friend class DebugTimedPhase;
+    const char* m_name;
+    ::std::atomic<uint64_t> m_value;
+    DebugPhaseCounter*  m_next;
+public:
+    DebugPhaseCounter(const char* name);
+    DebugPhaseCounter(const DebugPhaseCounter&) = delete;
+
+    void inc() {
+        m_value.fetch_add(1, ::std::memory_order_relaxed);
+    }
+    void add(uint64_t v) {
+        m_value.fetch_add(v, ::std::memory_order_relaxed);
+    }
+};
 
 class DebugTimedPhase
 {
     const char* m_name;
     clock_t m_start;
+    ::std::chrono::steady_clock::time_point m_start_wall;
+    uint64_t    m_start_rss;
+    uint64_t    m_start_allocs;
+    ::std::vector<uint64_t> m_start_counters;
 public:
     DebugTimedPhase(const char* name);
     ~DebugTimedPhase();
@@ -9,6 +9,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <cassert>
 #include <rc_string.hpp>
 
 struct Ident
@@ -21,91 +23,109 @@ struct Ident
         friend std::ostream& operator<<(std::ostream& os, const ModPath& x);
     };
 
-    // TODO: make this a reference-counted pointer instead (so it's cheaper to copy)
-    // - Presents challenges with setting the module path, and how this is used in macros.
+    /// Macro hygiene context: a chain of scope indexes (outermost first), plus an optional module to resolve paths in
+    /// - Immutable and shared: copies are a refcount increment, and chained scopes point at their parent
     class Hygiene
     {
         static unsigned g_next_scope;
 
-        struct Inner {
-            ::std::vector<unsigned int> contexts;
-            ::std::shared_ptr<ModPath> search_module;
+        struct Node {
+            mutable ::std::atomic<unsigned> refcount;
+            /// Number of scopes in the chain ending at this node (0 = an empty chain, only used to carry a module path)
+            unsigned int    depth;
+            /// Scope index (unused if `depth` is 0)
+            unsigned int    index;
+            /// Rest of the chain (null if `depth` <= 1), holds a reference
+            const Node* parent;
+            ::std::shared_ptr<const ModPath> search_module;
         };
-        // NOTE: Use a unique pointer to reduce the size to 1 pointer (instead of 5)
-        // - Used quite a bit, and parse sometimes runs out of stack.
-        ::std::unique_ptr<Inner>    m_inner;
+        // NOTE: A single pointer (null for the empty hygiene), as this is stored in every token and ident
+        // - Parse sometimes runs out of stack.
+        const Node* m_inner;
 
-        Hygiene(unsigned int index):
-            m_inner(new Inner())
-        {
-            m_inner->contexts.push_back(index);
+        static const Node* make_node(unsigned depth, unsigned index, const Node* parent, ::std::shared_ptr<const ModPath> search_module) {
+            if(parent) parent->refcount.fetch_add(1, ::std::memory_order_relaxed);
+            return new Node { {1}, depth, index, parent, ::std::move(search_module) };
+        }
+        static void release(const Node* n) {
+            while( n && n->refcount.fetch_sub(1, ::std::memory_order_acq_rel) == 1 ) {
+                const Node* p = n->parent;
+                delete n;
+                n = p;
+            }
         }
-              Inner* operator->()       { return &*m_inner; }
-        const Inner* operator->() const { return &*m_inner; }
+        explicit Hygiene(const Node* n): m_inner(n) {}
+        unsigned depth() const { return m_inner ? m_inner->depth : 0; }
+        /// Node for the scope chain (ignoring the module path), null if empty
+        const Node* scope_node() const { return depth() > 0 ? m_inner : nullptr; }
+        ::std::vector<unsigned> contexts() const;
     public:
         Hygiene():
-            m_inner(new Inner())
+            m_inner(nullptr)
         {}
         Hygiene(const Hygiene& x):
-            m_inner(new Inner(*x.m_inner))
+            m_inner(x.m_inner)
         {
+            if(m_inner) m_inner->refcount.fetch_add(1, ::std::memory_order_relaxed);
         }
         Hygiene& operator=(const Hygiene& x) {
-            *this = Hygiene(x);
-            assert(this->m_inner);
+            if( x.m_inner ) x.m_inner->refcount.fetch_add(1, ::std::memory_order_relaxed);
+            release(m_inner);
+            m_inner = x.m_inner;
             return *this;
         }
 
-        //Hygiene(Hygiene&& x) = default;
-        Hygiene(Hygiene&& x): m_inner(std::move(x.m_inner)) {
-            //assert(m_inner);
+        Hygiene(Hygiene&& x): m_inner(x.m_inner) {
+            x.m_inner = nullptr;
         }
         Hygiene& operator=(Hygiene&& x) {
-            m_inner.reset(x.m_inner.release());
-            //assert(m_inner);
+            if( &x != this ) {
+                release(m_inner);
+                m_inner = x.m_inner;
+                x.m_inner = nullptr;
+            }
             return *this;
         }
+        ~Hygiene() {
+            release(m_inner);
+        }
 
         static Hygiene new_scope()
         {
-            return Hygiene(++g_next_scope);
+            return Hygiene(make_node(1, ++g_next_scope, nullptr, nullptr));
         }
         static Hygiene new_scope_chained(const Hygiene& parent)
         {
-            Hygiene rv;
-            rv->search_module = parent->search_module;
-            rv->contexts.reserve( parent->contexts.size() + 1 );
-            rv->contexts.insert( rv->contexts.begin(),  parent->contexts.begin(), parent->contexts.end() );
-            rv->contexts.push_back( ++g_next_scope );
-            return rv;
-        }
-        Hygiene get_parent() const
-        {
-            //assert(this->contexts.size() > 1);
-            Hygiene rv;
-            rv->contexts.insert(rv->contexts.begin(),  m_inner->contexts.begin(), m_inner->contexts.end()-1);
-            return rv;
+            return Hygiene(make_node(parent.depth() + 1, ++g_next_scope, parent.scope_node(), parent.has_mod_path() ? parent.m_inner->search_module : nullptr));
         }
+        /// Scope chain without the innermost scope (and without a module path)
+        Hygiene get_parent() const;
 
         bool has_mod_path() const {
-            return m_inner->search_module != 0;
+            return m_inner && m_inner->search_module;
         }
         const ModPath& mod_path() const {
-            assert(m_inner->search_module);
+            assert(has_mod_path());
             return *m_inner->search_module;
         }
-        void set_mod_path(ModPath p) {
-            m_inner->search_module.reset( new ModPath(::std::move(p)) );
-        }
+        void set_mod_path(ModPath p);
 
         // Returns true if an ident with hygine `source` can see an ident with this hygine
         bool is_visible(const Hygiene& source) const;
-        Ordering ord(const Hygiene& x) const { ORD(m_inner->contexts, x->contexts); /*ORD(*m_inner->search_module, *x->search_module);*/ return OrdEqual; }
+        // NOTE: Only compares the scope chain, not the module path
+        Ordering ord(const Hygiene& x) const {
+            // Fast path: shared chains (the common case, as hygiene is copied into each token)
+            if( scope_node() == x.scope_node() )
+                return OrdEqual;
+            return ord_slow(x);
+        }
         bool operator==(const Hygiene& x) const { return ord(x) == OrdEqual; }
         bool operator!=(const Hygiene& x) const { return ord(x) != OrdEqual; }
         bool operator<(const Hygiene& x) const { return ord(x) == OrdLess; }
 
         friend ::std::ostream& operator<<(::std::ostream& os, const Hygiene& v);
+    private:
+        Ordering ord_slow(const Hygiene& x) const;
     };
 
     Hygiene hygiene;
@@ -0,0 +1,77 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/item_profile.hpp
+ * - Per-item compile-time profiling (`-Z profile-items`)
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <utility>
+
+extern bool g_item_profile_enabled;
+
+/// Enable per-item profiling, printing the `top_n` most expensive items of each category on exit
+extern void item_profile_enable(unsigned top_n);
+/// Add to a named counter on the innermost active `ItemProfileScope` (on this thread)
+extern void item_profile_count(const char* name, uint64_t value);
+
+/// Attributes the time spent in this scope (and any counters added) to the named item
+/// - Records are keyed on (category, item), repeated scopes for the same item accumulate
+class ItemProfileScope
+{
+    const char* m_category;
+    ::std::string   m_item;
+    ::std::chrono::steady_clock::time_point m_start;
+    ::std::vector<::std::pair<const char*, uint64_t>>    m_counters;
+    ItemProfileScope*   m_parent;
+public:
+    template<typename T>
+    ItemProfileScope(const char* category, const T& item):
+        m_category(nullptr),
+        m_parent(nullptr)
+    {
+        if( g_item_profile_enabled ) {
+            ::std::ostringstream    ss;
+            ss << item;
+            m_item = ss.str();
+            m_category = category;
+            this->start();
+        }
+    }
+    ItemProfileScope(const ItemProfileScope&) = delete;
+    ~ItemProfileScope() {
+        if( m_category ) {
+            this->finish();
+        }
+    }
+
+    void add_count(const char* name, uint64_t value);
+
+    /// Run `f`, adding the time it took (in microseconds) to the named counter
+    template<typename Fcn>
+    auto time_pass(const char* name, Fcn f) -> decltype(f()) {
+        if( !m_category ) {
+            return f();
+        }
+        struct Timer {
+            ItemProfileScope& s;
+            const char* name;
+            ::std::chrono::steady_clock::time_point start;
+            ~Timer() {
+                auto d = ::std::chrono::steady_clock::now() - start;
+                s.add_count(name, ::std::chrono::duration_cast<::std::chrono::microseconds>(d).count());
+            }
+        } t { *this, name, ::std::chrono::steady_clock::now() };
+        return f();
+    }
+
+    friend void item_profile_count(const char* name, uint64_t value);
+private:
+    void start();
+    void finish();
+};
@@ -0,0 +1,79 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/parallel.hpp
+ * - Worker thread support for parallelised passes (`-Z threads=N`)
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <debug.hpp>
+
+/// Number of threads used by parallelised passes (1 = run on the calling thread)
+extern unsigned g_parallel_threads;
+/// Set while worker threads are running
+/// - Code that updates shared global state (e.g. renumbering caches) checks this
+extern bool g_parallel_active;
+
+/// Call `fcn(state, i)` for each `i` in `0 .. count`, spread across `g_parallel_threads` threads
+/// - `init()` is called once per thread to create the per-thread state (e.g. a resolver)
+/// - Items are handed out in order, but may complete in any order. `fcn` must only write to per-item state.
+/// - The first exception thrown by a worker is re-thrown on the calling thread once all workers have stopped
+/// - Runs serially if debug output is enabled for the current phase, so the log isn't interleaved
+template<typename Init, typename Fcn>
+void Parallel_ForEach(size_t count, Init init, Fcn fcn)
+{
+    size_t n_threads = ::std::min<size_t>(g_parallel_threads, count);
+    if( n_threads <= 1 || g_parallel_active || debug_enabled() )
+    {
+        auto state = init();
+        for(size_t i = 0; i < count; i ++)
+            fcn(state, i);
+        return ;
+    }
+
+    ::std::atomic<size_t>   next_idx { 0 };
+    ::std::atomic<bool> failed { false };
+    ::std::exception_ptr    first_error;
+    ::std::mutex    error_lock;
+    auto worker = [&]() {
+        try
+        {
+            auto state = init();
+            for(;;)
+            {
+                if( failed.load(::std::memory_order_relaxed) )
+                    break;
+                size_t i = next_idx.fetch_add(1);
+                if( i >= count )
+                    break;
+                fcn(state, i);
+            }
+        }
+        catch(...)
+        {
+            ::std::lock_guard<::std::mutex> lh { error_lock };
+            if( !first_error )
+                first_error = ::std::current_exception();
+            failed = true;
+        }
+    };
+
+    g_parallel_active = true;
+    ::std::vector<::std::thread>    threads;
+    threads.reserve(n_threads - 1);
+    for(size_t i = 1; i < n_threads; i ++)
+        threads.push_back(::std::thread(worker));
+    worker();
+    for(auto& t : threads)
+        t.join();
+    g_parallel_active = false;
+
+    if( first_error )
+        ::std::rethrow_exception(first_error);
+}
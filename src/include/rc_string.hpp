@@ -9,16 +9,23 @@
 
 #include <cstring>
 #include <ostream>
+#include <atomic>
+#include <cstdint>
 #include "../common.hpp"
 
 class RcString
 {
+    static const size_t HASH_EMPTY = 5381;
     struct Inner {
-        unsigned int    refcount;
+        ::std::atomic<unsigned int> refcount;
         unsigned int    size;
-        unsigned int    ordering;   // Populated only for interned strings, 0 otherwise
+        /// Order label, populated only for interned strings (0 otherwise)
+        /// - Labels are sparse, and are only rewritten for a range of neighbours when an insert runs out of room
+        ::std::atomic<uint64_t> ordering;
+        size_t  hash;   // Cached `std::hash` value
         unsigned int    data[1];    // Actually arbitary
     }*  m_ptr;
+    friend struct RcString_InternLabels;    // rc_string.cpp
 public:
     RcString():
         m_ptr(nullptr)
@@ -44,7 +51,7 @@ public:
     RcString(const RcString& x):
         m_ptr(x.m_ptr)
     {
-        if( m_ptr ) m_ptr->refcount += 1;
+        if( m_ptr ) m_ptr->refcount.fetch_add(1, ::std::memory_order_relaxed);
     }
     RcString(RcString&& x):
         m_ptr(x.m_ptr)
@@ -60,7 +67,7 @@ public:
         {
             this->~RcString();
             m_ptr = x.m_ptr;
-            if( m_ptr ) m_ptr->refcount += 1;
+            if( m_ptr ) m_ptr->refcount.fetch_add(1, ::std::memory_order_relaxed);
         }
         return *this;
     }
@@ -78,7 +85,7 @@ public:
     const char* begin() const { return c_str(); }
     const char* end() const { return c_str() + size(); }
 
-    bool is_interned() const { return m_ptr && m_ptr->ordering != 0; }
+    bool is_interned() const { return m_ptr && m_ptr->ordering.load(::std::memory_order_relaxed) != 0; }
     size_t size() const { return m_ptr ? m_ptr->size : 0; }
     const char* c_str() const {
         if( m_ptr )
@@ -91,6 +98,9 @@ public:
         }
     }
 
+    /// Hash of the string content (computed on construction)
+    size_t hash() const { return m_ptr ? m_ptr->hash : HASH_EMPTY; }
+
     char back() const {
         assert(size() > 0 );
         return *(c_str() + size() - 1);
@@ -163,6 +173,8 @@ namespace std {
     }
     template<> struct hash<RcString>
     {
-        size_t operator()(const RcString& s) const noexcept;
+        size_t operator()(const RcString& s) const noexcept {
+            return s.hash();
+        }
     };
 }
@@ -16,6 +16,7 @@
 #include <ast/expr.hpp>
 #include <ast/crate.hpp>
 #include <hir/hir.hpp>  // HIR::Crate
+#include <debug_inner.hpp>
 
  // Map of: LoopIndex=>(Path=>Count)
 typedef std::map<unsigned, std::map< std::vector<unsigned>, unsigned > >    loop_counts_t;
@@ -1991,15 +1992,32 @@ namespace
     }
 }
 
+namespace {
+    DebugPhaseCounter   s_counter_arms_tried("macro_rules_arms_tried");
+    DebugPhaseCounter   s_counter_arms_skipped("macro_rules_arms_skipped");
+}
 unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& rules, TokenTree input, const AST::Crate& crate, AST::Module& mod,  ParameterMappings& bound_tts)
 {
     TRACE_FUNCTION_F(rules.m_rules.size() << " options");
     ASSERT_BUG(sp, rules.m_rules.size() > 0, "Empty macro_rules set");
 
+    // Arms that can't match the first input token are skipped without starting the matcher
+    auto lead_lex = TokenStreamRO(input);
+    const Token& lead_tok = lead_lex.next_tok();
+
     ::std::vector< ::std::pair<size_t, ::std::vector<bool>> >    matches;
     ::std::vector< std::pair<size_t, eTokenType> >  fail_pos;
     for(size_t i = 0; i < rules.m_rules.size(); i ++)
     {
+        const auto& arm_lead = rules.m_rules[i].m_lead_tok;
+        if( arm_lead != TOK_NULL && arm_lead != lead_tok )
+        {
+            DEBUG(i << " SKIPPED (needs " << arm_lead << ")");
+            s_counter_arms_skipped.inc();
+            fail_pos.push_back( std::make_pair(lead_lex.position(), lead_tok.type()) );
+            continue ;
+        }
+        s_counter_arms_tried.inc();
         auto lex = TokenStreamRO(input);
         auto arm_stream = MacroPatternStream(rules.m_rules[i].m_pattern);
 
@@ -2077,6 +2095,8 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
         {
             matches.push_back( ::std::make_pair(i, arm_stream.take_history()) );
             DEBUG(i << " MATCHED");
+            // Only the first matching arm is used, so there's no need to check the rest
+            break;
         }
         else
         {
@@ -168,17 +168,26 @@ struct MacroRulesArm
     /// Rule contents
     ::std::vector<MacroExpansionEnt> m_contents;
 
+    /// Token that the input must start with for this arm to match (TOK_NULL if not known)
+    /// - Lets invocation skip arms without starting the full matcher
+    Token   m_lead_tok;
+
     ~MacroRulesArm();
     MacroRulesArm()
     {}
     MacroRulesArm(::std::vector<SimplePatEnt> pattern, ::std::vector<MacroExpansionEnt> contents):
         m_pattern( mv$(pattern) ),
         m_contents( mv$(contents) )
-    {}
+    {
+        update_lead_tok();
+    }
     MacroRulesArm(const MacroRulesArm&) = delete;
     MacroRulesArm& operator=(const MacroRulesArm&) = delete;
     MacroRulesArm(MacroRulesArm&&) = default;
     MacroRulesArm& operator=(MacroRulesArm&&) = default;
+
+    /// Populate `m_lead_tok` from `m_pattern`
+    void update_lead_tok();
 };
 
 /// A sigle 'macro_rules!' block
@@ -294,4 +294,17 @@ MacroRules::~MacroRules()
 MacroRulesArm::~MacroRulesArm()
 {
 }
+void MacroRulesArm::update_lead_tok()
+{
+    // Only the first entry is considered, as that's what the matcher checks before anything else
+    if( m_pattern.empty() || m_pattern.front().is_End() ) {
+        m_lead_tok = Token(TOK_EOF);
+    }
+    else if( const auto* e = m_pattern.front().opt_ExpectTok() ) {
+        m_lead_tok = e->clone();
+    }
+    else {
+        m_lead_tok = Token();
+    }
+}
 
@@ -26,10 +26,13 @@
 #include "mir/main_bindings.hpp"
 #include "trans/main_bindings.hpp"
 #include "trans/target.hpp"
+#include "trans/mangling.hpp"
 
 #include "expand/cfg.hpp"
 #include <target_detect.h>	// tools/common/target_detect.h
 #include <debug_inner.hpp>
+#include <item_profile.hpp>
+#include <parallel.hpp>
 
 #ifdef _WIN32
 # define NOGDI
@@ -59,6 +62,8 @@ struct ProgramParams
     ::std::string   target = DEFAULT_TARGET_NAME;
 
     ::std::string   emit_depfile;
+    /// File created once the crate metadata (`.hir`) is written, so dependent crates can start before codegen is done
+    ::std::string   emit_metadata_marker;
 
     AST::Edition      edition = AST::Edition::Rust2015;
     ::AST::Crate::Type  crate_type = ::AST::Crate::Type::Unknown;
@@ -95,11 +100,22 @@ struct ProgramParams
         bool dump_ast = false;
         bool dump_hir = false;
         bool dump_mir = false;
+
+        /// Path for machine-readable phase timing output
+        ::std::string   time_passes_path;
+        /// Number of items to show per category in the per-item profile (zero to disable)
+        unsigned    profile_items = 0;
+        /// Number of worker threads for parallelised passes (zero to use all cores)
+        unsigned    threads = 1;
     } debug;
     struct {
         ::std::string   codegen_type;
         ::std::string   emit_build_command;
         ::std::string   panic_type;
+        unsigned int    codegen_units = 1;
+        bool    short_symbols = false;
+        bool    share_generics = true;
+        bool    merge_instances = true;
     } codegen;
 
     ProgramParams(int argc, char *argv[]);
@@ -176,8 +192,10 @@ void init_debug_list()
         "Trans Auto Impls",
         "Trans Monomorph",
         "MIR Optimise Inline",
+        "Trans Record Shared",
         "MIR Optimise Inline PostSave",
         "Trans Enumerate Cleanup",
+        "Trans Merge Instances",
         "Trans Codegen"
         });
 }
@@ -245,6 +263,20 @@ int main(int argc, char *argv[])
     init_debug_list();
     ProgramParams   params(argc, argv);
 
+    if( params.debug.time_passes_path != "" )
+    {
+        debug_timing_open(params.debug.time_passes_path.c_str());
+    }
+    if( params.debug.profile_items > 0 )
+    {
+        item_profile_enable(params.debug.profile_items);
+    }
+    g_parallel_threads = params.debug.threads;
+    if( g_parallel_threads == 0 )
+    {
+        g_parallel_threads = ::std::max(1u, ::std::thread::hardware_concurrency());
+    }
+
     if(params.debug.pause) {
         char c;
         ::std::cerr << "Pausing to attach a debugger\nType any text to continue" << std::endl;
@@ -550,9 +582,14 @@ int main(int argc, char *argv[])
 
             of << params.outfile << ":";
             // - Iterate all loaded crates files
+            // > Libraries only read the metadata, anything linked also depends on the library itself
+            bool is_linked = crate.m_crate_type != ::AST::Crate::Type::RustLib || params.test_harness;
             for(const auto& ec : crate.m_extern_crates)
             {
-                of << " " << ec.second.m_filename;
+                of << " " << ec.second.m_filename << ".hir";
+                if( is_linked ) {
+                    of << " " << ec.second.m_filename;
+                }
             }
             // - Iterate all extra files (include! and friends)
         }
@@ -666,6 +703,8 @@ int main(int argc, char *argv[])
         CompilePhaseV("Typecheck Outer", [&]() {
             Typecheck_ModuleLevel(*hir_crate);
             });
+        // Impl headers are now fixed, so trait impl searches can be memoised from here on
+        hir_crate->m_trait_impl_cache.enable();
         // Check the rest of the expressions (including function bodies)
         CompilePhaseV("Typecheck Expressions", [&]() {
             Typecheck_Expressions(*hir_crate);
@@ -803,6 +842,18 @@ int main(int argc, char *argv[])
         TransOptions    trans_opt;
         trans_opt.mode = params.codegen.codegen_type == "" ? "c" : params.codegen.codegen_type;
         trans_opt.build_command_file = params.codegen.emit_build_command;
+        trans_opt.codegen_units = params.codegen.codegen_units;
+        g_mangle_short_symbols = params.codegen.short_symbols;
+        hir_crate->m_short_symbols = params.codegen.short_symbols;
+        for(const auto& ec : hir_crate->m_ext_crates)
+        {
+            if( ec.second.m_data->m_short_symbols != g_mangle_short_symbols ) {
+                ERROR(Span(), E0000, "Crate `" << ec.first << "` (" << ec.second.m_path << ") was compiled "
+                    << (ec.second.m_data->m_short_symbols ? "with" : "without") << " `-C short-symbols`, but this crate is being compiled "
+                    << (g_mangle_short_symbols ? "with" : "without") << " it - symbol names would not match");
+            }
+        }
+        g_trans_share_generics = params.codegen.share_generics;
         trans_opt.opt_level = params.opt_level;
         trans_opt.panic_crate = params.codegen.panic_type == "" ? "panic_abort" : "panic_"+params.codegen.panic_type;
         for(const char* libdir : params.lib_search_dirs ) {
@@ -829,6 +880,7 @@ int main(int argc, char *argv[])
                 HIR::Crate  crate_for_ser;
                 crate_for_ser.m_crate_name = hir_crate->m_crate_name;
                 crate_for_ser.m_edition    = hir_crate->m_edition;
+                crate_for_ser.m_short_symbols = hir_crate->m_short_symbols;
                 for(const auto& i : hir_crate->m_root_module.m_macro_items) {
                     DEBUG(i.first << ": " << i.second->ent.tag_str());
                     if( const auto* e = i.second->ent.opt_ProcMacro() ) {
@@ -877,9 +929,15 @@ int main(int argc, char *argv[])
         switch(crate_type)
         {
         case ::AST::Crate::Type::RustLib:
+            // Let downstream crates link to this crate's generic instances
+            CompilePhaseV("Trans Record Shared", [&]() { Trans_Enumerate_RecordShared(*hir_crate, items); });
             // Save a loadable HIR dump
             hir_file = params.outfile + ".hir";
             CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(hir_file, *hir_crate); });
+            if( params.emit_metadata_marker != "" )
+            {
+                ::std::ofstream(params.emit_metadata_marker);
+            }
             break;
         case ::AST::Crate::Type::RustDylib:
             // Save a loadable HIR dump
@@ -898,6 +956,11 @@ int main(int argc, char *argv[])
         CompilePhaseV("MIR Optimise Inline PostSave", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items, true); });
         // - Clean up ununused functions
         CompilePhaseV("Trans Enumerate Cleanup", [&]() { Trans_Enumerate_Cleanup(*hir_crate, items); });
+        // - Emit instances with identical code only once
+        if( params.codegen.merge_instances )
+        {
+            CompilePhaseV("Trans Merge Instances", [&]() { Trans_Monomorphise_MergeInstances(*hir_crate, items); });
+        }
 
         switch(crate_type)
         {
@@ -1090,10 +1153,33 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     get_optval();
                     this->emit_depfile = optval;
                 }
+                else if( optname == "emit-metadata-marker" ) {
+                    get_optval();
+                    this->emit_metadata_marker = optval;
+                }
                 else if( optname == "panic" ) {
                     get_optval();
                     this->codegen.panic_type = optval;
                 }
+                else if( optname == "codegen-units" ) {
+                    get_optval();
+                    char* end;
+                    auto v = ::std::strtoul(optval.c_str(), &end, 10);
+                    if( *end != '\0' || v == 0 ) {
+                        ::std::cerr << "Invalid value for -C codegen-units - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                    this->codegen.codegen_units = static_cast<unsigned int>(v);
+                }
+                else if( optname == "short-symbols" ) {
+                    this->codegen.short_symbols = true;
+                }
+                else if( optname == "no-share-generics" ) {
+                    this->codegen.share_generics = false;
+                }
+                else if( optname == "no-merge-instances" ) {
+                    this->codegen.merge_instances = false;
+                }
                 else {
                     ::std::cerr << "Unknown codegen option: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -1171,6 +1257,32 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                         exit(1);
                     }
                 }
+                else if( optname == "time-passes" ) {
+                    get_optval();
+                    this->debug.time_passes_path = optval;
+                }
+                else if( optname == "profile-items" ) {
+                    this->debug.profile_items = 20;
+                    if( eq_pos != ::std::string::npos ) {
+                        char* end;
+                        auto v = ::std::strtoul(optval.c_str(), &end, 10);
+                        if( *end != '\0' || v == 0 ) {
+                            ::std::cerr << "Invalid value for -Z profile-items - '" << optval << "'" << ::std::endl;
+                            exit(1);
+                        }
+                        this->debug.profile_items = static_cast<unsigned>(v);
+                    }
+                }
+                else if( optname == "threads" ) {
+                    get_optval();
+                    char* end;
+                    auto v = ::std::strtoul(optval.c_str(), &end, 10);
+                    if( *end != '\0' ) {
+                        ::std::cerr << "Invalid value for -Z threads - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                    this->debug.threads = static_cast<unsigned>(v);
+                }
                 else if( optname == "pause-after-start" ) {
                     this->debug.pause = true;
                 }
@@ -794,7 +794,7 @@ void MIR_BorrowCheck_Crate(::HIR::Crate& crate)
     ::MIR::OuterVisitor    ov { crate, [&](const auto& res, const auto& p, ::HIR::ExprPtr& expr_ptr, const auto& args, const auto& ty){
         MIR_BorrowCheck(res, p, expr_ptr.get_mir_or_error_mut(Span()), args, ty);
     } };
-    ov.visit_crate(crate);
+    ov.visit_crate_parallel(crate);
 }
 
 
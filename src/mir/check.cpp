@@ -1268,5 +1268,5 @@ void MIR_CheckCrate(/*const*/ ::HIR::Crate& crate)
             MIR_Validate(res, p, *expr.m_mir, args, ty);
         }
         );
-    ov.visit_crate( crate );
+    ov.visit_crate_parallel( crate );
 }
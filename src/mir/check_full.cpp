@@ -460,7 +460,7 @@ namespace
                 state_p = &locals.at(e);
                 ),
             (Static,
-                static State    state_of_static(true);
+                thread_local static State    state_of_static(true);
                 return state_of_static;
                 )
             )
@@ -1028,6 +1028,6 @@ void MIR_CheckCrate_Full(/*const*/ ::HIR::Crate& crate)
             MIR_Validate_Full(res, p, *expr.m_mir, args, ty);
         }
         );
-    ov.visit_crate( crate );
+    ov.visit_crate_parallel( crate );
 }
 
@@ -1478,6 +1478,6 @@ void MIR_CleanupCrate(::HIR::Crate& crate)
             MIR_Cleanup(res, p, expr_ptr.get_mir_or_error_mut(Span()), args, ty);
             MIR_Validate(res, p, expr_ptr.get_mir_or_error_mut(Span()), args, ty);
         } };
-    ov.visit_crate(crate);
+    ov.visit_crate_parallel(crate);
 }
 
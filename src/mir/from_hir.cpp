@@ -3019,7 +3019,7 @@ void HIR_GenerateMIR(::HIR::Crate& crate)
                 expr_ptr.set_mir( LowerMIR(res, p, expr_ptr, ty, args) );
             }
         } };
-    ov.visit_crate(crate);
+    ov.visit_crate_parallel(crate);
 
     // Once MIR is generated, free the HIR expression tree (replace each node with an empty tuple node)
     ::MIR::OuterVisitor ov_free(crate, [&](const auto& res, const auto& p, ::HIR::ExprPtr& expr_ptr, const auto& args, const auto& ty){
@@ -7,13 +7,36 @@
  */
 #include "mir_ptr.hpp"
 #include "mir.hpp"
+#include <mutex>
 
+namespace {
+    // Serialises loading of lazy bodies (they're rare and short, so one lock is enough)
+    ::std::mutex    s_lazy_load_lock;
+}
+
+::MIR::LazyFunction::~LazyFunction()
+{
+}
 
 void ::MIR::FunctionPointer::reset()
 {
+    if( auto* l = this->lazy.exchange(nullptr) ) {
+        delete l;
+    }
     if( this->ptr ) {
         delete this->ptr;
         this->ptr = nullptr;
     }
 }
 
+void ::MIR::FunctionPointer::materialise() const
+{
+    ::std::lock_guard<::std::mutex> lh { s_lazy_load_lock };
+    // Another thread may have loaded it while this one waited
+    if( auto* l = this->lazy.load(::std::memory_order_relaxed) )
+    {
+        this->ptr = l->load();
+        this->lazy.store(nullptr, ::std::memory_order_release);
+        delete l;
+    }
+}
@@ -6,18 +6,30 @@
  * - Pointer to a blob of MIR
  */
 #pragma once
+#include <atomic>
 
 namespace MIR {
 
 class Function;
 
+/// Deferred source of a MIR body (e.g. an undecoded chunk of extern crate metadata)
+class LazyFunction
+{
+public:
+    virtual ~LazyFunction();
+    virtual ::MIR::Function* load() = 0;
+};
+
 class FunctionPointer
 {
-    ::MIR::Function*    ptr;
+    mutable ::MIR::Function*    ptr;
+    /// If non-null, the body hasn't been loaded yet (`ptr` is only valid once this is null)
+    mutable ::std::atomic<LazyFunction*>    lazy;
 public:
-    FunctionPointer(): ptr(nullptr) {}
-    FunctionPointer(::MIR::Function* p): ptr(p) {}
-    FunctionPointer(FunctionPointer&& x): ptr(x.ptr) { x.ptr = nullptr; }
+    FunctionPointer(): ptr(nullptr), lazy(nullptr) {}
+    FunctionPointer(::MIR::Function* p): ptr(p), lazy(nullptr) {}
+    FunctionPointer(LazyFunction* l): ptr(nullptr), lazy(l) {}
+    FunctionPointer(FunctionPointer&& x): ptr(x.ptr), lazy(x.lazy.exchange(nullptr)) { x.ptr = nullptr; }
 
     ~FunctionPointer() {
         reset();
@@ -25,18 +37,31 @@ public:
     FunctionPointer& operator=(FunctionPointer&& x) {
         reset();
         ptr = x.ptr;
+        lazy = x.lazy.exchange(nullptr);
         x.ptr = nullptr;
         return *this;
     }
 
     void reset();
 
-          ::MIR::Function* operator->()       { if(!ptr) throw ""; return ptr; }
-    const ::MIR::Function* operator->() const { if(!ptr) throw ""; return ptr; }
-          ::MIR::Function& operator*()       { if(!ptr) throw ""; return *ptr; }
-    const ::MIR::Function& operator*() const { if(!ptr) throw ""; return *ptr; }
+          ::MIR::Function* operator->()       { return get_nonnull(); }
+    const ::MIR::Function* operator->() const { return get_nonnull(); }
+          ::MIR::Function& operator*()       { return *get_nonnull(); }
+    const ::MIR::Function& operator*() const { return *get_nonnull(); }
+
+    // NOTE: Doesn't force a lazy body to load
+    operator bool() const { return lazy.load(::std::memory_order_acquire) != nullptr || ptr != nullptr; }
+    /// True if the body is present and doesn't need decoding
+    bool is_loaded() const { return lazy.load(::std::memory_order_acquire) == nullptr && ptr != nullptr; }
 
-    operator bool() const { return ptr != nullptr; }
+private:
+    ::MIR::Function* get_nonnull() const {
+        if( lazy.load(::std::memory_order_acquire) )
+            materialise();
+        if(!ptr) throw "";
+        return ptr;
+    }
+    void materialise() const;
 };
 
 }
@@ -18,6 +18,10 @@
 #include <iomanip>
 #include <trans/target.hpp>
 #include <trans/trans_list.hpp> // Note: This is included for inlining after enumeration and monomorph
+#include <item_profile.hpp>
+#include <parallel.hpp>
+#include <mutex>
+#include <unordered_map>
 
 #include <hir/expr.hpp> // HACK
 
@@ -51,6 +55,13 @@ bool MIR_Optimise_UselessReborrows(::MIR::TypeResolve& state, ::MIR::Function& f
 bool MIR_Optimise_GarbageCollect_Partial(::MIR::TypeResolve& state, ::MIR::Function& fcn);
 bool MIR_Optimise_GarbageCollect(::MIR::TypeResolve& state, ::MIR::Function& fcn);
 
+namespace {
+    /// Set while `MIR_OptimiseCrate` runs in parallel: the batch each of the crate's bodies is optimised in
+    /// - Inlining only reads bodies from earlier batches (which are complete), later ones are treated as opaque
+    const ::std::unordered_map<const ::MIR::Function*, unsigned>*  s_crate_opt_batches = nullptr;
+    thread_local unsigned t_crate_opt_batch = 0;
+}
+
 enum {
     CHECKMODE_UNKNOWN,
     CHECKMODE_NONE,
@@ -58,9 +69,9 @@ enum {
     CHECKMODE_PASS,
     CHECKMODE_ALL,
 };
-static int check_mode() {
-    static int mode = CHECKMODE_UNKNOWN;
-    if( mode == CHECKMODE_UNKNOWN ) {
+static int check_mode_from_env() {
+    int mode = CHECKMODE_UNKNOWN;
+    {
         const auto* n = getenv("MRUSTC_MIR_CHECK");
         if(n)
         {
@@ -90,6 +101,11 @@ static int check_mode() {
     }
     return mode;
 }
+static int check_mode() {
+    // NOTE: Static initialisation, so it's safe when optimising on worker threads
+    static const int mode = check_mode_from_env();
+    return mode;
+}
 static bool check_after_all() {
     return check_mode() >= CHECKMODE_ALL;
 }
@@ -163,6 +179,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 {
     static Span sp;
     TRACE_FUNCTION_F(path);
+    ItemProfileScope    profile("MIR Optimise", path);
     ::MIR::TypeResolve   state { sp, resolve, FMT_CB(ss, ss << path;), ret_type, args, fcn };
 
     bool change_happened;
@@ -175,7 +192,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         TRACE_FUNCTION_FR("Pass " << pass_num, change_happened);
 
         // >> Simplify call graph (removes gotos to blocks with a single use)
-        if( MIR_Optimise_BlockSimplify(state, fcn) )
+        if( profile.time_pass("BlockSimplify_us", [&]{ return MIR_Optimise_BlockSimplify(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -188,7 +205,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         //else { MIR_Validate(resolve, path, fcn, args, ret_type); }
 
         // >> Apply known constants
-        if( MIR_Optimise_ConstPropagate(state, fcn) )
+        if( profile.time_pass("ConstPropagate_us", [&]{ return MIR_Optimise_ConstPropagate(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -200,10 +217,10 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         }
 
         // >> Attempt to remove useless temporaries
-        if( MIR_Optimise_DeTemporary(state, fcn) )
+        if( profile.time_pass("DeTemporary_us", [&]{ return MIR_Optimise_DeTemporary(state, fcn); }) )
         {
             // - Run until no changes
-            while( MIR_Optimise_DeTemporary(state, fcn) )
+            while( profile.time_pass("DeTemporary_us", [&]{ return MIR_Optimise_DeTemporary(state, fcn); }) )
             {
                 if( check_after_all() ) {
                     MIR_Validate(resolve, path, fcn, args, ret_type);
@@ -220,7 +237,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         //else { MIR_Validate(resolve, path, fcn, args, ret_type); }
 
         // >> Split apart aggregates that are never used such (Written once, never used directly)
-        if( MIR_Optimise_SplitAggregates(state, fcn) )
+        if( profile.time_pass("SplitAggregates_us", [&]{ return MIR_Optimise_SplitAggregates(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -234,7 +251,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 
         // >> Replace values from composites if they're known
         //   - Undoes the inefficiencies from the `match (a, b) { ... }` pattern
-        if( MIR_Optimise_PropagateKnownValues(state, fcn) )
+        if( profile.time_pass("PropagateKnownValues_us", [&]{ return MIR_Optimise_PropagateKnownValues(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -249,10 +266,10 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         // TODO: Convert `&mut *mut_foo` into `mut_foo` if the source is movable and not used afterwards
 
         // >> Propagate/remove dead assignments
-        if( MIR_Optimise_PropagateSingleAssignments(state, fcn) )
+        if( profile.time_pass("PropagateSingleAssignments_us", [&]{ return MIR_Optimise_PropagateSingleAssignments(state, fcn); }) )
         {
             // - Run until no changes
-            while( MIR_Optimise_PropagateSingleAssignments(state, fcn) )
+            while( profile.time_pass("PropagateSingleAssignments_us", [&]{ return MIR_Optimise_PropagateSingleAssignments(state, fcn); }) )
             {
             }
 #if DUMP_AFTER_ALL
@@ -275,7 +292,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         //}
 
         // >> Combine Duplicate Blocks
-        if( MIR_Optimise_UnifyBlocks(state, fcn) )
+        if( profile.time_pass("UnifyBlocks_us", [&]{ return MIR_Optimise_UnifyBlocks(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -286,7 +303,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             change_happened = true;
         }
         // >> Remove assignments of unsed drop flags
-        if( MIR_Optimise_DeadDropFlags(state, fcn) )
+        if( profile.time_pass("DeadDropFlags_us", [&]{ return MIR_Optimise_DeadDropFlags(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -297,7 +314,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             change_happened = true;
         }
         // >> Remove assignments that are never read
-        if( MIR_Optimise_DeadAssignments(state, fcn) )
+        if( profile.time_pass("DeadAssignments_us", [&]{ return MIR_Optimise_DeadAssignments(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -308,7 +325,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
             change_happened = true;
         }
         // >> Remove no-op assignments
-        if( MIR_Optimise_NoopRemoval(state, fcn) )
+        if( profile.time_pass("NoopRemoval_us", [&]{ return MIR_Optimise_NoopRemoval(state, fcn); }) )
         {
 #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -320,7 +337,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         }
 
         // >> Remove re-borrow operations that don't need to exist
-        if( MIR_Optimise_UselessReborrows(state, fcn) )
+        if( profile.time_pass("UselessReborrows_us", [&]{ return MIR_Optimise_UselessReborrows(state, fcn); }) )
         {
             #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -332,7 +349,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         }
 
         // >> If the first statement of a block is an assignment, and the last op of the previous is to that assignment's source, move up.
-        if( MIR_Optimise_GotoAssign(state, fcn) )
+        if( profile.time_pass("GotoAssign_us", [&]{ return MIR_Optimise_GotoAssign(state, fcn); }) )
         {
             #if DUMP_AFTER_ALL
             if( debug_enabled() ) MIR_Dump_Fcn(::std::cout, fcn);
@@ -346,7 +363,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         // >> Inline short functions
         if( do_inline && !change_happened )
         {
-            if( MIR_Optimise_Inlining(state, fcn, /*minimal=*/false) )
+            if( profile.time_pass("Inlining_us", [&]{ return MIR_Optimise_Inlining(state, fcn, /*minimal=*/false); }) )
             {
                 // Apply cleanup again (as monomorpisation in inlining may have exposed a vtable call)
                 MIR_Cleanup(resolve, path, fcn, args, ret_type);
@@ -374,7 +391,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
         }
         //else { MIR_Validate(resolve, path, fcn, args, ret_type); }
 
-        if( MIR_Optimise_GarbageCollect_Partial(state, fcn) )
+        if( profile.time_pass("GarbageCollect_Partial_us", [&]{ return MIR_Optimise_GarbageCollect_Partial(state, fcn); }) )
         {
             change_happened = true;
 #if DUMP_AFTER_ALL
@@ -394,6 +411,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 #endif
         pass_num += 1;
     } while( change_happened );
+    profile.add_count("outer_passes", pass_num);
 
     // Run UnifyTemporaries last, then unify blocks, then run some
     // optimisations that might be affected
@@ -422,7 +440,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
     }
     // GC pass on blocks and variables
     // - Find unused blocks, then delete and rewrite all references.
-    MIR_Optimise_GarbageCollect(state, fcn);
+    profile.time_pass("GarbageCollect_us", [&]{ return MIR_Optimise_GarbageCollect(state, fcn); });
 
     //MIR_Validate_Full(resolve, path, fcn, args, ret_type);
 
@@ -740,6 +758,10 @@ namespace
             DEBUG("fcn_params = " << *params.fcn_params);
 
             const auto& hir_fcn = *it->second->ptr;
+            if( it->second->shared_upstream ) {
+                // Emitted by an upstream crate, treat as external
+                return nullptr;
+            }
             if( it->second->monomorphised.code ) {
                 //DEBUG("Found monomorphised - PP=" << params.impl_params << "," << *params.fcn_params);
                 return &*it->second->monomorphised.code;
@@ -784,7 +806,16 @@ namespace
             }
         TU_ARMA(Function, f) {
             params.fcn_params_def = &f->m_params;
-            return f->m_code.get_mir_opt();
+            const auto* mir = f->m_code.get_mir_opt();
+            if( mir && s_crate_opt_batches )
+            {
+                auto it = s_crate_opt_batches->find(mir);
+                if( it != s_crate_opt_batches->end() && it->second >= t_crate_opt_batch ) {
+                    DEBUG("Not yet optimised (batch " << it->second << ")");
+                    return nullptr;
+                }
+            }
+            return mir;
             }
         }
         return nullptr;
@@ -6481,6 +6512,77 @@ void MIR_SortBlocks(const StaticTraitResolve& resolve, const ::HIR::ItemPath& pa
 }
 
 
+namespace {
+    /// Split the crate's bodies into batches for parallel optimisation, such that each body comes after the bodies it could inline
+    /// - Bodies in call cycles are given one batch each (in visit order), so the result doesn't depend on thread scheduling
+    ::std::unordered_map<const ::MIR::Function*, unsigned> MIR_OptimiseCrate_GetBatches(::HIR::Crate& crate)
+    {
+        ::std::vector<const ::MIR::Function*>   bodies;
+        ::std::vector<::std::vector<const ::MIR::Function*>>    callees;
+        ::MIR::OuterVisitor ov { crate, [&](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
+            {
+                const auto& mir = expr.get_mir_or_error(Span());
+                ::std::vector<const ::MIR::Function*>   list;
+                for(const auto& bb : mir.blocks)
+                {
+                    const auto* te = bb.terminator.opt_Call();
+                    if( !te || !te->fcn.is_Path() )
+                        continue ;
+                    MonomorphState  ms;
+                    auto v = res.get_value(Span(), te->fcn.as_Path(), ms);
+                    if( const auto* f = v.opt_Function() ) {
+                        if( const auto* callee = (*f)->m_code.get_mir_opt() )
+                            list.push_back(callee);
+                    }
+                }
+                bodies.push_back(&mir);
+                callees.push_back(::std::move(list));
+            }
+            };
+        ov.visit_crate(crate);
+
+        const unsigned UNSET = ~0u;
+        ::std::unordered_map<const ::MIR::Function*, size_t>    indexes;
+        for(size_t i = 0; i < bodies.size(); i ++)
+            indexes.insert(::std::make_pair(bodies[i], i));
+        ::std::vector<unsigned> batch(bodies.size(), UNSET);
+        size_t  n_done = 0;
+        for(unsigned cur = 0; n_done < bodies.size(); cur ++)
+        {
+            ::std::vector<size_t>   ready;
+            for(size_t i = 0; i < bodies.size(); i ++)
+            {
+                if( batch[i] != UNSET )
+                    continue ;
+                bool is_ready = true;
+                for(const auto* c : callees[i])
+                {
+                    auto it = indexes.find(c);
+                    if( it != indexes.end() && it->second != i && batch[it->second] >= cur ) {
+                        is_ready = false;
+                        break;
+                    }
+                }
+                if( is_ready )
+                    ready.push_back(i);
+            }
+            if( ready.empty() )
+            {
+                // Call cycle - take the first remaining body
+                ready.push_back( ::std::find(batch.begin(), batch.end(), UNSET) - batch.begin() );
+            }
+            for(auto i : ready)
+                batch[i] = cur;
+            n_done += ready.size();
+        }
+
+        ::std::unordered_map<const ::MIR::Function*, unsigned> rv;
+        for(size_t i = 0; i < bodies.size(); i ++)
+            rv.insert(::std::make_pair(bodies[i], batch[i]));
+        return rv;
+    }
+}
+
 void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
 {
     ::MIR::OuterVisitor ov { crate, [do_minimal_optimisation](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
@@ -6489,6 +6591,9 @@ void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
             //    return ;
             //}
             auto& mir = expr.get_mir_or_error_mut(Span());
+            if( s_crate_opt_batches ) {
+                t_crate_opt_batch = s_crate_opt_batches->at(&mir);
+            }
             if( do_minimal_optimisation ) {
                 MIR_OptimiseMin(res, p, mir, args, ty);
             }
@@ -6497,7 +6602,12 @@ void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
             }
         }
         };
-    ov.visit_crate(crate);
+    // Inlining reads other bodies, so bodies are optimised in batches ordered by the call graph
+    // - The same order is used with a single thread (batches then run sequentially), so output doesn't depend on the thread count
+    auto batches = MIR_OptimiseCrate_GetBatches(crate);
+    s_crate_opt_batches = &batches;
+    ov.visit_crate_parallel(crate, [&](const ::HIR::ExprPtr& expr){ return batches.at(&expr.get_mir_or_error(Span())); });
+    s_crate_opt_batches = nullptr;
 }
 
 void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool post_save)
@@ -6515,7 +6625,11 @@ void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool
         {
             auto& hir_fcn = *const_cast<::HIR::Function*>(fcn_ent.second->ptr);
             ::MIR::Function* fcn_p;
-            if( fcn_ent.second->monomorphised.code ) {
+            if( fcn_ent.second->shared_upstream ) {
+                DEBUG("Shared upstream: " << fcn_ent.first);
+                continue ;
+            }
+            else if( fcn_ent.second->monomorphised.code ) {
                 DEBUG("Generic: " << fcn_ent.first);
                 fcn_p = &*fcn_ent.second->monomorphised.code;
             }
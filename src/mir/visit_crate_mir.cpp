@@ -7,6 +7,86 @@
  */
 #include "visit_crate_mir.hpp"
 #include <hir/expr.hpp>
+#include <parallel.hpp>
+#include <algorithm>
+
+namespace {
+    const ::HIR::Function::args_t   empty_args;
+}
+
+/// A body collected by `visit_crate_parallel`, with enough state to re-create the resolver and path on a worker
+struct MIR::OuterVisitor::Deferred
+{
+    /// Copy of the item path chain (the visitor's is on the stack), the last entry is the item itself
+    ::std::vector<::HIR::ItemPath>  path;
+    MetadataType    self_metadata;
+    const ::HIR::GenericParams* impl_generics;
+    const ::HIR::GenericParams* item_generics;
+
+    ::HIR::ExprPtr* expr;
+    const ::HIR::Function::args_t*  args;
+    ::HIR::TypeRef  ret_type;
+};
+
+void MIR::OuterVisitor::visit_crate_parallel(::HIR::Crate& crate, ::std::function<unsigned(const ::HIR::ExprPtr&)> get_batch)
+{
+    ::std::vector<Deferred> deferred;
+    m_deferred = &deferred;
+    this->visit_crate(crate);
+    m_deferred = nullptr;
+
+    // Order by batch (stable, so visit order is kept within a batch)
+    ::std::vector<::std::pair<unsigned, size_t>>  order;
+    order.reserve(deferred.size());
+    for(size_t i = 0; i < deferred.size(); i ++)
+        order.push_back(::std::make_pair(get_batch ? get_batch(*deferred[i].expr) : 0, i));
+    ::std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+
+    for(size_t start = 0; start < order.size(); )
+    {
+        size_t end = start;
+        while( end < order.size() && order[end].first == order[start].first )
+            end ++;
+        Parallel_ForEach(end - start, [&](){ return StaticTraitResolve { crate }; }, [&](StaticTraitResolve& resolve, size_t i) {
+            const auto& d = deferred[order[start + i].second];
+            if( d.impl_generics )
+                resolve.set_impl_generics_raw(d.self_metadata, *d.impl_generics);
+            if( d.item_generics )
+                resolve.set_item_generics_raw(*d.item_generics);
+            m_cb(resolve, d.path.back(), *d.expr, d.args ? *d.args : empty_args, d.ret_type);
+            resolve.clear_both_generics();
+            });
+        start = end;
+    }
+}
+
+void MIR::OuterVisitor::run_cb(const ::HIR::ItemPath& ip, ::HIR::ExprPtr& expr, const ::HIR::Function::args_t* args, const ::HIR::TypeRef& ret_type)
+{
+    if( !m_deferred )
+    {
+        m_cb(m_resolve, ip, expr, args ? *args : empty_args, ret_type);
+        return ;
+    }
+
+    Deferred    d;
+    // Copy the path chain root-first, then re-link the parents (the vector isn't resized after this)
+    size_t  len = 0;
+    for(const auto* p = &ip; p; p = p->parent)
+        len ++;
+    d.path.resize(len, ::HIR::ItemPath(""));
+    size_t  i = len;
+    for(const auto* p = &ip; p; p = p->parent)
+        d.path[--i] = *p;
+    for(size_t i = 1; i < len; i ++)
+        d.path[i].parent = &d.path[i-1];
+    d.self_metadata = m_resolve.self_metadata();
+    d.impl_generics = m_resolve.m_impl_generics;
+    d.item_generics = m_resolve.m_item_generics;
+    d.expr = &expr;
+    d.args = args;
+    d.ret_type = ret_type.clone();
+    m_deferred->push_back(mv$(d));
+}
 
 // NOTE: This is left here to ensure that any expressions that aren't handled by higher code cause a failure
 void MIR::OuterVisitor::visit_expr(::HIR::ExprPtr& exp)
@@ -22,7 +102,7 @@ void MIR::OuterVisitor::visit_type(::HIR::TypeRef& ty)
         DEBUG("Array size " << ty);
         if( auto* se1 = e->size.opt_Unevaluated() ) {
             if( auto* se = se1->opt_Unevaluated() ) {
-                m_cb(m_resolve, ::HIR::ItemPath(""), *(*se)->expr, {}, ::HIR::TypeRef(::HIR::CoreType::Usize));
+                this->run_cb(::HIR::ItemPath(""), *(*se)->expr, nullptr, ::HIR::TypeRef(::HIR::CoreType::Usize));
             }
         }
     }
@@ -37,7 +117,7 @@ void MIR::OuterVisitor::visit_function(::HIR::ItemPath p, ::HIR::Function& item)
     if( item.m_code || item.m_code.m_mir )
     {
         DEBUG("Function code " << p);
-        m_cb(m_resolve, p, item.m_code, item.m_args, item.m_return);
+        this->run_cb(p, item.m_code, &item.m_args, item.m_return);
     }
 }
 void MIR::OuterVisitor::visit_static(::HIR::ItemPath p, ::HIR::Static& item)
@@ -45,7 +125,7 @@ void MIR::OuterVisitor::visit_static(::HIR::ItemPath p, ::HIR::Static& item)
     auto _ = this->m_resolve.set_item_generics(item.m_params);
     if( item.m_value ) {
         DEBUG("`static` value " << p);
-        m_cb(m_resolve, p, item.m_value, {}, item.m_type);
+        this->run_cb(p, item.m_value, nullptr, item.m_type);
     }
 }
 void MIR::OuterVisitor::visit_constant(::HIR::ItemPath p, ::HIR::Constant& item)
@@ -53,7 +133,7 @@ void MIR::OuterVisitor::visit_constant(::HIR::ItemPath p, ::HIR::Constant& item)
     auto _ = this->m_resolve.set_item_generics(item.m_params);
     if( item.m_value ) {
         DEBUG("`const` value " << p);
-        m_cb(m_resolve, p, item.m_value, {}, item.m_type);
+        this->run_cb(p, item.m_value, nullptr, item.m_type);
     }
 }
 void MIR::OuterVisitor::visit_enum(::HIR::ItemPath p, ::HIR::Enum& item)
@@ -67,7 +147,7 @@ void MIR::OuterVisitor::visit_enum(::HIR::ItemPath p, ::HIR::Enum& item)
         for(auto& var : e->variants)
         {
             if( var.expr ) {
-                m_cb(m_resolve, p + var.name, var.expr, {}, enum_type);
+                this->run_cb(p + var.name, var.expr, nullptr, enum_type);
             }
         }
     }
@@ -17,14 +17,25 @@ class OuterVisitor:
 public:
     typedef ::std::function<void(const StaticTraitResolve& resolve, const ::HIR::ItemPath& ip, ::HIR::ExprPtr& expr, const ::HIR::Function::args_t& args, const ::HIR::TypeRef& ret_type)>  cb_t;
 private:
+    struct Deferred;
+
     StaticTraitResolve  m_resolve;
     cb_t  m_cb;
+    /// Set during `visit_crate_parallel`, bodies are collected here instead of being passed to `m_cb`
+    ::std::vector<Deferred>*    m_deferred;
 public:
     OuterVisitor(const ::HIR::Crate& crate, cb_t cb):
         m_resolve(crate),
-        m_cb(cb)
+        m_cb(cb),
+        m_deferred(nullptr)
     {}
 
+    /// Visit the crate, then pass each body to the callback on worker threads (see `-Z threads`)
+    /// - Each thread has its own resolver, and bodies are handed out in visit order
+    /// - The callback must only modify the body it is given
+    /// - If `get_batch` is provided, bodies are grouped by its result and each batch completes before the next starts
+    void visit_crate_parallel(::HIR::Crate& crate, ::std::function<unsigned(const ::HIR::ExprPtr&)> get_batch={});
+
     void visit_expr(::HIR::ExprPtr& exp) override;
 
     void visit_type(::HIR::TypeRef& ty) override;
@@ -41,6 +52,8 @@ public:
     void visit_trait(::HIR::ItemPath p, ::HIR::Trait& item) override;
     void visit_type_impl(::HIR::TypeImpl& impl) override;
     void visit_trait_impl(const ::HIR::SimplePath& trait_path, ::HIR::TraitImpl& impl) override;
+private:
+    void run_cb(const ::HIR::ItemPath& ip, ::HIR::ExprPtr& expr, const ::HIR::Function::args_t* args, const ::HIR::TypeRef& ret_type);
 };
 
 
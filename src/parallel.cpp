@@ -0,0 +1,11 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * parallel.cpp
+ * - Worker thread support for parallelised passes
+ */
+#include <parallel.hpp>
+
+unsigned g_parallel_threads = 1;
+bool g_parallel_active = false;
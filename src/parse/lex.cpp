@@ -16,50 +16,97 @@
 #include <algorithm>    // std::count
 #include <limits>       // std::numeric_limits
 #include <cctype>
+#include <iterator>     // std::istreambuf_iterator
 //#define TRACE_CHARS
 //#define TRACE_RAW_TOKENS
 
+namespace {
+    enum {
+        CC_SPACE = 1,   // Non-newline ASCII whitespace
+        CC_IDENT = 2,   // ASCII identifier characters
+        CC_LINECOMMENT = 4,  // Line comment body
+        CC_BLOCKCOMMENT = 8, // Block comment body, excluding the `/` and `*` that could start/end a nested comment
+        CC_STRING = 16,  // String literal body, excluding escapes and the terminating quote
+    };
+    /// Character classes for the ASCII fast paths
+    /// - Newlines and non-ASCII bytes are never in a class, so they always go through `getc` (for line counting and UTF-8 decoding)
+    struct CharClassTable {
+        uint8_t v[256];
+        CharClassTable() {
+            for(unsigned i = 0; i < 256; i ++)
+            {
+                uint8_t c = 0;
+                if( i < 128 && i != '\n' && i != '\r' ) {
+                    if( i == ' ' || i == '\t' || i == 0xC )
+                        c |= CC_SPACE;
+                    if( ('0' <= i && i <= '9') || ('a' <= i && i <= 'z') || ('A' <= i && i <= 'Z') || i == '_' )
+                        c |= CC_IDENT;
+                    c |= CC_LINECOMMENT;
+                    if( i != '/' && i != '*' )
+                        c |= CC_BLOCKCOMMENT;
+                    if( i != '"' && i != '\\' )
+                        c |= CC_STRING;
+                }
+                v[i] = c;
+            }
+        }
+    } const s_char_class;
+}
+
 Lexer::Lexer(const ::std::string& filename, AST::Edition edition, ParseState ps):
     TokenStream(ps),
     m_path(filename.c_str()),
     m_line(1),
     m_line_ofs(0),
-    m_istream_fp(filename != "-" ? new std::ifstream(filename.c_str()) : nullptr),
-    m_istream(filename != "-" ? *m_istream_fp : std::cin),
+    m_pos(0),
     m_last_char_valid(false),
     m_edition(edition),
     m_hygiene( Ident::Hygiene::new_scope() )
 {
-    if( m_istream_fp )
+    if( filename != "-" )
     {
-        if( !m_istream_fp->is_open() )
+        ::std::ifstream is(filename.c_str(), ::std::ios::binary);
+        if( !is.is_open() )
         {
             throw ::std::runtime_error("Unable to open file '" + filename + "'");
         }
+        is.seekg(0, ::std::ios::end);
+        auto len = is.tellg();
+        is.seekg(0, ::std::ios::beg);
+        if( len > 0 ) {
+            m_data.resize(static_cast<size_t>(len));
+            is.read(&m_data[0], len);
+            m_data.resize(static_cast<size_t>(is.gcount()));
+        }
+        else {
+            // Size unknown (e.g. a pipe, where `tellg` fails) - read until EOF
+            is.clear();
+            m_data.assign( ::std::istreambuf_iterator<char>(is), ::std::istreambuf_iterator<char>() );
+        }
         // Consume the BOM
-        if( this->getc_byte() == '\xef' )
+        if( m_data.size() > 0 && m_data[0] == '\xef' )
         {
-            if( this->getc_byte() != '\xbb' ) {
+            if( m_data.size() < 2 || m_data[1] != '\xbb' ) {
                 throw ::std::runtime_error("Incomplete BOM - missing \\xBB in second position");
             }
-            if( this->getc_byte() != '\xbf' ) {
+            if( m_data.size() < 3 || m_data[2] != '\xbf' ) {
                 throw ::std::runtime_error("Incomplete BOM - missing \\xBF in third position");
             }
-            m_line_ofs = 0;
-        }
-        else
-        {
-            m_istream.unget();
+            m_pos = 3;
         }
     }
+    else
+    {
+        m_data.assign( ::std::istreambuf_iterator<char>(::std::cin), ::std::istreambuf_iterator<char>() );
+    }
 }
 Lexer::Lexer(::std::istringstream& ss, AST::Edition edition, ParseState ps)
     : TokenStream(ps)
     , m_path("-")
     , m_line(1)
     , m_line_ofs(0)
-    , m_istream_fp(nullptr)
-    , m_istream(ss)
+    , m_data( ::std::istreambuf_iterator<char>(ss), ::std::istreambuf_iterator<char>() )
+    , m_pos(0)
     , m_last_char_valid(false)
     , m_edition(edition)
     , m_hygiene( Ident::Hygiene::new_scope() )
@@ -385,6 +432,7 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
+            this->skip_run(CC_SPACE);
             while( (ch = this->getc()).isspace() && ch != '\n' )
                 ;
             this->ungetc();
@@ -629,6 +677,7 @@ Token Lexer::getTokenInt()
                 while(ch != '\n' && ch != '\r')
                 {
                     str += ch;
+                    this->append_run(str, CC_LINECOMMENT);
                     ch = this->getc();
                 }
                 this->ungetc();
@@ -697,6 +746,7 @@ Token Lexer::getTokenInt()
                         }
                         else {
                             str += ch;
+                            this->append_run(str, CC_BLOCKCOMMENT);
                         }
                     }
                     ch = this->getc();
@@ -765,6 +815,7 @@ Token Lexer::getTokenInt()
                     else
                     {
                         str += ch;
+                        this->append_run(str, CC_STRING);
                     }
                 }
                 return Token(TOK_STRING, mv$(str), realGetHygiene());
@@ -866,6 +917,7 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2, bool pa
     while( issym(ch) )
     {
         str += ch;
+        this->append_run(str, CC_IDENT);
         ch = this->getc();
     }
 
@@ -1122,18 +1174,15 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    int rv = m_istream.get();
-    if( rv == EOF )
+    if( m_pos == m_data.size() )
         throw Lexer::EndOfFile();
+    char rv = m_data[m_pos++];
 
     if( rv == '\r' )
     {
-        if( m_istream.get() != '\n' )
-        {
-            m_istream.unget();
-        }
-        else
+        if( m_pos < m_data.size() && m_data[m_pos] == '\n' )
         {
+            m_pos ++;
             rv = '\n';
         }
     }
@@ -1230,6 +1279,32 @@ Codepoint Lexer::getc_cp()
     }
 }
 
+void Lexer::append_run(::std::string& out, uint8_t cls)
+{
+    // Only valid directly after a `getc` (a pushed-back character has to be seen first)
+    if( m_last_char_valid )
+        return ;
+    size_t start = m_pos;
+    size_t end = start;
+    const size_t len = m_data.size();
+    while( end < len && (s_char_class.v[static_cast<uint8_t>(m_data[end])] & cls) )
+        end ++;
+    out.append(m_data, start, end - start);
+    m_line_ofs += end - start;
+    m_pos = end;
+}
+void Lexer::skip_run(uint8_t cls)
+{
+    if( m_last_char_valid )
+        return ;
+    size_t end = m_pos;
+    const size_t len = m_data.size();
+    while( end < len && (s_char_class.v[static_cast<uint8_t>(m_data[end])] & cls) )
+        end ++;
+    m_line_ofs += end - m_pos;
+    m_pos = end;
+}
+
 void Lexer::ungetc()
 {
 #ifdef TRACE_CHARS
@@ -39,8 +39,9 @@ class Lexer:
     unsigned int m_line;
     unsigned int m_line_ofs;
 
-    ::std::unique_ptr<::std::ifstream>  m_istream_fp;
-    ::std::istream& m_istream;
+    /// Entire source text (read up-front, so runs of plain ASCII can be consumed without per-character decoding)
+    ::std::string   m_data;
+    size_t  m_pos;
     bool    m_last_char_valid;
     Codepoint   m_last_char;
     ::std::vector<Token>    m_next_tokens;
@@ -82,6 +83,10 @@ private:
     }
 
     void ungetc();
+    /// Append a run of ASCII characters of the given class (see `s_char_class`) directly from the buffer
+    void append_run(::std::string& out, uint8_t cls);
+    /// Skip a run of ASCII characters of the given class
+    void skip_run(uint8_t cls);
     Codepoint getc_num();
     Codepoint getc();
     Codepoint getc_cp();
@@ -10,6 +10,8 @@
 #include <string>
 #include <iostream>
 #include <algorithm>    // std::max
+#include <mutex>
+#include <new>  // placement new
 
 RcString::RcString(const char* s, size_t len):
     m_ptr(nullptr)
@@ -17,23 +19,27 @@ RcString::RcString(const char* s, size_t len):
     if( len > 0 )
     {
         size_t nwords = (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int);
-        m_ptr = reinterpret_cast<Inner*>(malloc(sizeof(Inner) + (nwords - 1) * sizeof(unsigned int)));
-        m_ptr->refcount = 1;
+        m_ptr = new(malloc(sizeof(Inner) + (nwords - 1) * sizeof(unsigned int))) Inner;
+        m_ptr->refcount.store(1, ::std::memory_order_relaxed);
         m_ptr->size = static_cast<unsigned>(len);
-        m_ptr->ordering = 0;
+        m_ptr->ordering.store(0, ::std::memory_order_relaxed);
         char* data_mut = reinterpret_cast<char*>(m_ptr->data);
-        for(unsigned int j = 0; j < len; j ++ )
+        // http://www.cse.yorku.ca/~oz/hash.html "djb2"
+        size_t h = HASH_EMPTY;
+        for(unsigned int j = 0; j < len; j ++ ) {
             data_mut[j] = s[j];
+            h = h * 33 + (unsigned)s[j];
+        }
         data_mut[len] = '\0';
+        m_ptr->hash = h;
     }
 }
 RcString::~RcString()
 {
     if(m_ptr)
     {
-        m_ptr->refcount -= 1;
         //::std::cout << "RcString(" << m_ptr << " \"" << *this << "\") - " << *m_ptr << " refs left (drop)" << ::std::endl;
-        if( m_ptr->refcount == 0 )
+        if( m_ptr->refcount.fetch_sub(1, ::std::memory_order_acq_rel) == 1 )
         {
             free(m_ptr);
         }
@@ -79,11 +85,24 @@ Ordering RcString::ord(const char* s) const
 }
 
 
+struct RcString_InternLabels
+{
+    static uint64_t get(const RcString& s) {
+        return s.m_ptr->ordering.load(::std::memory_order_relaxed);
+    }
+    static void set(const RcString& s, uint64_t v) {
+        s.m_ptr->ordering.store(v, ::std::memory_order_relaxed);
+    }
+};
+
 // Replace the use of `std::set` with a collection of sorted buffers
 // Limit each entry to ~1024 items, and split in half when full.
 // - This limits the cost of insertion to just needing to move a maximum of 1024 items plus the ~170 items in the outer list (assuming an average of 75% usage)
 // - Numbers: libcargo 1.74 has 128,900 interned strings (of which 115,984 are in use at Trans), hence the above estimate of 170 blocks of 1024
 namespace {
+    /// Incremented before and after the interned labels are rewritten (odd while a relabel is in progress)
+    ::std::atomic<unsigned> RcString_interned_relabel_seq;
+
     struct StringView {
         const char* p;
         size_t l;
@@ -103,6 +122,12 @@ namespace {
 
     // This is faster than std::set, as it doesn't have to allocate `RcString` instances, and it has lower memory overhead
     const size_t BLOCK_SIZE = 1024;
+    // Ordering labels are in `1 .. LABEL_MAX`, with new strings given a label between their neighbours
+    // - When there's no room, the labels of the surrounding blocks are spread out (widening the range until
+    //   each gap is at least `LABEL_MIN_GAP`), so comparisons never need a full renumbering.
+    const uint64_t LABEL_MAX = uint64_t(1) << 62;
+    const uint64_t LABEL_MIN_GAP = uint64_t(1) << 16;
+    const uint64_t LABEL_APPEND_STEP = uint64_t(1) << 32;
     class TieredSet {
         struct Block {
             std::vector<RcString>   ents;
@@ -123,6 +148,7 @@ namespace {
             if( blocks.empty() ) {
                 blocks.push_back(Block());
                 blocks.front().ents.push_back(RcString(sv));
+                set_label(blocks.front().ents.front(), LABEL_APPEND_STEP);
                 return ::std::make_pair(&blocks.front().ents.front(), true);
             }
 
@@ -191,6 +217,60 @@ namespace {
             };
         }
     private:
+        static uint64_t get_label(const RcString& s) { return RcString_InternLabels::get(s); }
+        static void set_label(const RcString& s, uint64_t v) { RcString_InternLabels::set(s, v); }
+        /// Lowest/highest label allowed for entries in `blocks[b0 .. b1]` (i.e. the neighbouring labels)
+        uint64_t label_lower_bound(size_t b0) const {
+            return b0 > 0 ? get_label(blocks[b0-1].ents.back()) : 0;
+        }
+        uint64_t label_upper_bound(size_t b1) const {
+            return b1 + 1 < blocks.size() ? get_label(blocks[b1+1].ents.front()) : LABEL_MAX;
+        }
+        /// Give the newly-inserted string at `slot` a label between its neighbours
+        void assign_label(std::vector<Block>::iterator block, std::vector<RcString>::iterator slot)
+        {
+            const size_t bi = block - blocks.begin();
+            uint64_t lo = slot != block->ents.begin() ? get_label(*(slot - 1)) : label_lower_bound(bi);
+            uint64_t hi = slot + 1 != block->ents.end() ? get_label(*(slot + 1)) : label_upper_bound(bi);
+            if( hi - lo >= 2 ) {
+                // Leave room after the last string, as appending is common
+                uint64_t step = (hi == LABEL_MAX ? ::std::min(LABEL_APPEND_STEP, (hi - lo) / 2) : (hi - lo) / 2);
+                set_label(*slot, lo + step);
+                return ;
+            }
+            relabel_around(bi);
+        }
+        /// Spread out the labels of the blocks around `bi`, widening until there's enough room
+        void relabel_around(size_t bi)
+        {
+            size_t b0 = bi, b1 = bi;
+            for(size_t width = 1; ; width *= 2)
+            {
+                uint64_t lo = label_lower_bound(b0);
+                uint64_t hi = label_upper_bound(b1);
+                size_t count = 0;
+                for(size_t b = b0; b <= b1; b ++)
+                    count += blocks[b].ents.size();
+                uint64_t gap = (hi - lo) / (count + 1);
+                if( gap >= LABEL_MIN_GAP || (b0 == 0 && b1 + 1 == blocks.size()) )
+                {
+                    assert(gap >= 1);
+                    RcString_interned_relabel_seq.fetch_add(1, ::std::memory_order_relaxed);
+                    ::std::atomic_thread_fence(::std::memory_order_release);
+                    uint64_t v = lo;
+                    for(size_t b = b0; b <= b1; b ++)
+                    {
+                        for(auto& e : blocks[b].ents)
+                            set_label(e, v += gap);
+                    }
+                    RcString_interned_relabel_seq.fetch_add(1, ::std::memory_order_release);
+                    return ;
+                }
+                b0 = (b0 > width ? b0 - width : 0);
+                b1 = ::std::min(b1 + width, blocks.size() - 1);
+            }
+        }
+
         std::pair<const RcString*,bool> insert_into_block(std::vector<Block>::iterator block, std::vector<RcString>::iterator slot, RcString rv) {
             if( block->ents.size() == block->ents.capacity() ) {
                 // Block is full, so create a new block and split the contents between the two
@@ -204,6 +284,7 @@ namespace {
                     new_block->ents.push_back(rv);
                     slot = new_block->ents.insert(new_block->ents.end(), slot, block->ents.end()) - 1;
                     block->ents.resize(split_point);
+                    block = new_block;
                 }
                 else {
                     // Target is in the lower half, so copy the entities and then insert
@@ -216,6 +297,8 @@ namespace {
                 slot = block->ents.insert(slot, rv);
             }
 
+            assign_label(block, slot);
+
 #if 0
             StringView    prev { nullptr, 0 };
             for(auto& v : *this) {
@@ -237,43 +320,28 @@ namespace {
     };
 }
 TieredSet   RcString_interned_strings;
-bool    RcString_interned_ordering_valid;
+// Protects `RcString_interned_strings` (interning can happen on worker threads)
+::std::mutex    RcString_interned_lock;
 
 RcString RcString::new_interned(const char* s, size_t len)
 {
     if(len == 0)
         return RcString();
+    ::std::lock_guard<::std::mutex>  lh { RcString_interned_lock };
     auto ret = RcString_interned_strings.lookup_or_add(StringView { s, len });
-    // Set interned and invalidate the cache if an insert happened
-    if(ret.second)
-    {
-        ret.first->m_ptr->ordering = 1;
-        RcString_interned_ordering_valid = false;
-    }
     //assert( ret.first->ord(s, len) == 0 );
     return *ret.first;
 }
 Ordering RcString::ord_interned(const RcString& s) const
 {
     assert(s.is_interned() && this->is_interned());
-    if(!RcString_interned_ordering_valid)
-    {
-        // Populate cache
-        unsigned i = 1;
-        for(auto& e : RcString_interned_strings)
-            e.m_ptr->ordering = i++;
-        RcString_interned_ordering_valid = true;
-    }
-    return ::ord(this->m_ptr->ordering, s.m_ptr->ordering);
-}
-
-size_t std::hash<RcString>::operator()(const RcString& s) const noexcept
-{
-    // http://www.cse.yorku.ca/~oz/hash.html "djb2"
-    size_t h = 5381;
-    for(auto c : s) {
-        h = h * 33 + (unsigned)c;
-    }
-    return h;
-    //return hash<std::string_view>(s.c_str(), s.size());
+    // Labels can be rewritten by an insert on another thread (under the intern lock), so check that no relabel
+    // happened while reading them - and compare the strings instead if one did.
+    auto seq = RcString_interned_relabel_seq.load(::std::memory_order_acquire);
+    auto a = this->m_ptr->ordering.load(::std::memory_order_relaxed);
+    auto b = s.m_ptr->ordering.load(::std::memory_order_relaxed);
+    ::std::atomic_thread_fence(::std::memory_order_acquire);
+    if( (seq & 1) != 0 || RcString_interned_relabel_seq.load(::std::memory_order_relaxed) != seq )
+        return ord(s.c_str(), s.size());
+    return ::ord(a, b);
 }
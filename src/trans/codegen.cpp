@@ -15,6 +15,7 @@
 
 #include "codegen.hpp"
 #include "monomorphise.hpp"
+#include <item_profile.hpp>
 
 void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const TransOptions& opt, const ::HIR::Crate& crate, TransList list, const ::std::string& hir_file)
 {
@@ -27,7 +28,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
     }
     else if( opt.mode == "c" )
     {
-        codegen = Trans_Codegen_GetGeneratorC(crate, outfile);
+        codegen = Trans_Codegen_GetGeneratorC(crate, outfile, opt);
     }
     else
     {
@@ -180,6 +181,7 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
             const auto& fcn = *ent.second->ptr;
             const auto& pp = ent.second->pp;
             TRACE_FUNCTION_F(path);
+            ItemProfileScope    profile("Codegen", path);
             DEBUG("FUNCTION CODE " << path);
             // `is_extern` is set if there's no HIR (i.e. this function is from an external crate)
             bool is_extern = ! static_cast<bool>(fcn.m_code);
@@ -187,7 +189,10 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
             bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef::new_self();}) );
 
             bool is_monomorph = pp.has_types() || is_method;
-            if( ent.second->monomorphised.code ) {
+            if( ent.second->alias_of ) {
+                codegen->emit_function_alias(path, fcn, pp, is_extern, *ent.second->alias_of, ent.second->monomorphised.code);
+            }
+            else if( ent.second->monomorphised.code ) {
                 // TODO: Flag that this should be a weak (or weak-er) symbol?
                 // - If it's from an external crate, it should be weak, but what about local ones?
                 codegen->emit_function_code(path, fcn, pp, is_extern,  ent.second->monomorphised.code);
@@ -51,10 +51,15 @@ public:
     virtual void emit_function_ext(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params) {}
     virtual void emit_function_proto(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def) {}
     virtual void emit_function_code(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::MIR::FunctionPointer& code) = 0;
+    /// Emit a function whose generated code is identical to `target` (which has already been emitted)
+    /// - Backends without symbol aliases just emit the code again
+    virtual void emit_function_alias(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::HIR::Path& target, const ::MIR::FunctionPointer& code) {
+        emit_function_code(p, item, params, is_extern_def, code);
+    }
 
     virtual void emit_global_asm(const ::HIR::GlobalAssembly& ) = 0;
 };
 
-extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile);
+extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt);
 extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile);
 
@@ -20,6 +20,10 @@
 #include "allocator.hpp"
 #include <iomanip>
 #include "target_version.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <jobserver.h> // tools/common/jobserver.h
 
 namespace {
     struct FmtShell
@@ -200,6 +204,118 @@ namespace {
         return rv;
     }
 
+    /// Build a shell command line from an argument list
+    /// - Arguments from `arg_file_start` onwards are written to `command_file` (passed as `@file`)
+    ::std::string make_command(const StringList& args, size_t arg_file_start, const ::std::string& command_file, bool is_windows)
+    {
+        ::std::stringstream cmd_ss;
+        if (is_windows)
+        {
+            cmd_ss << "echo \"\" & ";
+        }
+        std::ofstream   command_file_stream;
+        if( getenv("MRUSTC_CCACHE") ) {
+            cmd_ss << "ccache ";
+        }
+        bool use_arg_file = arg_file_start > 0;
+        if(use_arg_file) {
+            command_file_stream.open(command_file);
+            ASSERT_BUG(Span(), command_file_stream.is_open(), "Failed to open command file `" << command_file << "` for writing");
+        }
+        size_t i = -1;
+        for(const auto& arg : args.get_vec())
+        {
+            i ++;
+            auto& out_ss = (use_arg_file && i >= arg_file_start ? static_cast<::std::ostream&>(command_file_stream) : cmd_ss);
+            if(strcmp(arg, "&") == 0 && is_windows) {
+                out_ss << "&";
+            }
+            else {
+                if( is_windows && strchr(arg, ' ') == nullptr ) {
+                    out_ss << arg << " ";
+                }
+                else {
+                    out_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
+                }
+            }
+        }
+        if(use_arg_file) {
+            cmd_ss << "@\"" << FmtShell(command_file, is_windows) << "\"";
+            command_file_stream.close();
+            ASSERT_BUG(Span(), !command_file_stream.bad(), "Error set on output stream for: " << command_file);
+        }
+        return cmd_ss.str();
+    }
+
+    /// Run shell commands concurrently
+    /// - Limited by the make jobserver if there is one (this process's implicit token runs one command), otherwise
+    ///   by the host's core count.
+    /// - Returns zero if all commands succeeded, otherwise the first failing exit code
+    int run_commands_parallel(const ::std::vector<::std::string>& cmds)
+    {
+        auto jobserver = JobServer::create(0);
+        const size_t max_local = ::std::max(1u, ::std::thread::hardware_concurrency());
+
+        ::std::mutex    lock;
+        ::std::condition_variable   cv;
+        size_t  n_running = 0;
+        size_t  n_tokens_released = 0;  // Jobserver tokens freed by completed commands (returned/reused by this thread)
+        int rv = 0;
+
+        ::std::vector<::std::thread>    threads;
+        for(const auto& cmd : cmds)
+        {
+            bool uses_token = false;
+            {
+                ::std::unique_lock<::std::mutex>    l(lock);
+                for(;;)
+                {
+                    if( n_running == 0 )
+                        break;
+                    if( !jobserver ) {
+                        if( n_running < max_local )
+                            break;
+                        cv.wait(l);
+                        continue ;
+                    }
+                    if( n_tokens_released > 0 ) {
+                        n_tokens_released -= 1;
+                        uses_token = true;
+                        break;
+                    }
+                    l.unlock();
+                    bool got_token = jobserver->take_one(100);
+                    l.lock();
+                    if( got_token ) {
+                        uses_token = true;
+                        break;
+                    }
+                }
+                n_running += 1;
+            }
+            threads.push_back(::std::thread([&,uses_token](const ::std::string* cmd) {
+                int ec = system(cmd->c_str());
+                ::std::lock_guard<::std::mutex> l(lock);
+                if( ec != 0 ) {
+                    ::std::cerr << "Command failed (" << ec << ") - " << *cmd << ::std::endl;
+                    if( rv == 0 )
+                        rv = (ec == -1 ? -1 : ec);
+                }
+                n_running -= 1;
+                if( uses_token )
+                    n_tokens_released += 1;
+                cv.notify_all();
+                }, &cmd));
+        }
+        for(auto& t : threads)
+            t.join();
+        if( jobserver ) {
+            for(; n_tokens_released > 0; n_tokens_released --)
+                jobserver->return_one();
+        }
+        return rv;
+    }
+
     enum class AtomicOp
     {
         Add,
@@ -209,6 +325,155 @@ namespace {
         Xor
     };
 
+    /// Mapping from a `llvm.x86.*` link name to the equivalent `<immintrin.h>` intrinsic
+    struct LlvmX86Intrinsic
+    {
+        const char* llvm_name;
+        const char* c_name;
+        /// GCC `target` attribute required to call the intrinsic
+        const char* target;
+        /// Return type then argument types: `v` void, `i` scalar, `x`/`f`/`d` 128-bit int/float/double vector, `X`/`F`/`D` 256-bit
+        const char* sig;
+    };
+    const LlvmX86Intrinsic LLVM_X86_INTRINSICS[] = {
+        { "llvm.x86.sse.movmsk.ps", "_mm_movemask_ps", "sse", "if" },
+        { "llvm.x86.sse.max.ps", "_mm_max_ps", "sse", "fff" },
+        { "llvm.x86.sse.min.ps", "_mm_min_ps", "sse", "fff" },
+        { "llvm.x86.sse.rcp.ps", "_mm_rcp_ps", "sse", "ff" },
+        { "llvm.x86.sse.rsqrt.ps", "_mm_rsqrt_ps", "sse", "ff" },
+        { "llvm.x86.sse.sqrt.ps", "_mm_sqrt_ps", "sse", "ff" },
+        { "llvm.x86.sse.sfence", "_mm_sfence", "sse", "v" },
+        { "llvm.x86.sse2.pause", "_mm_pause", "sse2", "v" },
+        { "llvm.x86.sse2.lfence", "_mm_lfence", "sse2", "v" },
+        { "llvm.x86.sse2.mfence", "_mm_mfence", "sse2", "v" },
+        { "llvm.x86.sse2.pmovmskb.128", "_mm_movemask_epi8", "sse2", "ix" },
+        { "llvm.x86.sse2.movmsk.pd", "_mm_movemask_pd", "sse2", "id" },
+        { "llvm.x86.sse2.max.pd", "_mm_max_pd", "sse2", "ddd" },
+        { "llvm.x86.sse2.min.pd", "_mm_min_pd", "sse2", "ddd" },
+        { "llvm.x86.sse2.sqrt.pd", "_mm_sqrt_pd", "sse2", "dd" },
+        { "llvm.x86.sse2.pslli.w", "_mm_slli_epi16", "sse2", "xxi" },
+        { "llvm.x86.sse2.pslli.d", "_mm_slli_epi32", "sse2", "xxi" },
+        { "llvm.x86.sse2.pslli.q", "_mm_slli_epi64", "sse2", "xxi" },
+        { "llvm.x86.sse2.psrli.w", "_mm_srli_epi16", "sse2", "xxi" },
+        { "llvm.x86.sse2.psrli.d", "_mm_srli_epi32", "sse2", "xxi" },
+        { "llvm.x86.sse2.psrli.q", "_mm_srli_epi64", "sse2", "xxi" },
+        { "llvm.x86.sse2.psrai.w", "_mm_srai_epi16", "sse2", "xxi" },
+        { "llvm.x86.sse2.psrai.d", "_mm_srai_epi32", "sse2", "xxi" },
+        { "llvm.x86.sse2.psll.w", "_mm_sll_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.psll.d", "_mm_sll_epi32", "sse2", "xxx" },
+        { "llvm.x86.sse2.psll.q", "_mm_sll_epi64", "sse2", "xxx" },
+        { "llvm.x86.sse2.psrl.w", "_mm_srl_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.psrl.d", "_mm_srl_epi32", "sse2", "xxx" },
+        { "llvm.x86.sse2.psrl.q", "_mm_srl_epi64", "sse2", "xxx" },
+        { "llvm.x86.sse2.psra.w", "_mm_sra_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.psra.d", "_mm_sra_epi32", "sse2", "xxx" },
+        { "llvm.x86.sse2.pavg.b", "_mm_avg_epu8", "sse2", "xxx" },
+        { "llvm.x86.sse2.pavg.w", "_mm_avg_epu16", "sse2", "xxx" },
+        { "llvm.x86.sse2.pmadd.wd", "_mm_madd_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.pmulh.w", "_mm_mulhi_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.pmulhu.w", "_mm_mulhi_epu16", "sse2", "xxx" },
+        { "llvm.x86.sse2.psad.bw", "_mm_sad_epu8", "sse2", "xxx" },
+        { "llvm.x86.sse2.packsswb.128", "_mm_packs_epi16", "sse2", "xxx" },
+        { "llvm.x86.sse2.packssdw.128", "_mm_packs_epi32", "sse2", "xxx" },
+        { "llvm.x86.sse2.packuswb.128", "_mm_packus_epi16", "sse2", "xxx" },
+        { "llvm.x86.ssse3.pshuf.b.128", "_mm_shuffle_epi8", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.pmadd.ub.sw.128", "_mm_maddubs_epi16", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.pmul.hr.sw.128", "_mm_mulhrs_epi16", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.phadd.w.128", "_mm_hadd_epi16", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.phadd.d.128", "_mm_hadd_epi32", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.phsub.w.128", "_mm_hsub_epi16", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.phsub.d.128", "_mm_hsub_epi32", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.psign.b.128", "_mm_sign_epi8", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.psign.w.128", "_mm_sign_epi16", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.psign.d.128", "_mm_sign_epi32", "ssse3", "xxx" },
+        { "llvm.x86.ssse3.pabs.b.128", "_mm_abs_epi8", "ssse3", "xx" },
+        { "llvm.x86.ssse3.pabs.w.128", "_mm_abs_epi16", "ssse3", "xx" },
+        { "llvm.x86.ssse3.pabs.d.128", "_mm_abs_epi32", "ssse3", "xx" },
+        { "llvm.x86.sse41.ptestz", "_mm_testz_si128", "sse4.1", "ixx" },
+        { "llvm.x86.sse41.ptestc", "_mm_testc_si128", "sse4.1", "ixx" },
+        { "llvm.x86.sse41.ptestnzc", "_mm_testnzc_si128", "sse4.1", "ixx" },
+        { "llvm.x86.sse41.packusdw", "_mm_packus_epi32", "sse4.1", "xxx" },
+        { "llvm.x86.sse41.phminposuw", "_mm_minpos_epu16", "sse4.1", "xx" },
+        { "llvm.x86.sse42.crc32.32.8", "_mm_crc32_u8", "sse4.2", "iii" },
+        { "llvm.x86.sse42.crc32.32.16", "_mm_crc32_u16", "sse4.2", "iii" },
+        { "llvm.x86.sse42.crc32.32.32", "_mm_crc32_u32", "sse4.2", "iii" },
+        { "llvm.x86.sse42.crc32.64.64", "_mm_crc32_u64", "sse4.2", "iii" },
+        { "llvm.x86.avx.ptestz.256", "_mm256_testz_si256", "avx", "iXX" },
+        { "llvm.x86.avx.ptestc.256", "_mm256_testc_si256", "avx", "iXX" },
+        { "llvm.x86.avx.ptestnzc.256", "_mm256_testnzc_si256", "avx", "iXX" },
+        { "llvm.x86.avx.movmsk.ps.256", "_mm256_movemask_ps", "avx", "iF" },
+        { "llvm.x86.avx.movmsk.pd.256", "_mm256_movemask_pd", "avx", "iD" },
+        { "llvm.x86.avx2.pmovmskb", "_mm256_movemask_epi8", "avx2", "iX" },
+        { "llvm.x86.avx2.pshuf.b", "_mm256_shuffle_epi8", "avx2", "XXX" },
+        { "llvm.x86.avx2.permd", "_mm256_permutevar8x32_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.pslli.w", "_mm256_slli_epi16", "avx2", "XXi" },
+        { "llvm.x86.avx2.pslli.d", "_mm256_slli_epi32", "avx2", "XXi" },
+        { "llvm.x86.avx2.pslli.q", "_mm256_slli_epi64", "avx2", "XXi" },
+        { "llvm.x86.avx2.psrli.w", "_mm256_srli_epi16", "avx2", "XXi" },
+        { "llvm.x86.avx2.psrli.d", "_mm256_srli_epi32", "avx2", "XXi" },
+        { "llvm.x86.avx2.psrli.q", "_mm256_srli_epi64", "avx2", "XXi" },
+        { "llvm.x86.avx2.psrai.w", "_mm256_srai_epi16", "avx2", "XXi" },
+        { "llvm.x86.avx2.psrai.d", "_mm256_srai_epi32", "avx2", "XXi" },
+        { "llvm.x86.avx2.psllv.d", "_mm_sllv_epi32", "avx2", "xxx" },
+        { "llvm.x86.avx2.psllv.d.256", "_mm256_sllv_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.psllv.q", "_mm_sllv_epi64", "avx2", "xxx" },
+        { "llvm.x86.avx2.psllv.q.256", "_mm256_sllv_epi64", "avx2", "XXX" },
+        { "llvm.x86.avx2.psrlv.d", "_mm_srlv_epi32", "avx2", "xxx" },
+        { "llvm.x86.avx2.psrlv.d.256", "_mm256_srlv_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.psrlv.q", "_mm_srlv_epi64", "avx2", "xxx" },
+        { "llvm.x86.avx2.psrlv.q.256", "_mm256_srlv_epi64", "avx2", "XXX" },
+        { "llvm.x86.avx2.psrav.d", "_mm_srav_epi32", "avx2", "xxx" },
+        { "llvm.x86.avx2.psrav.d.256", "_mm256_srav_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.pavg.b", "_mm256_avg_epu8", "avx2", "XXX" },
+        { "llvm.x86.avx2.pavg.w", "_mm256_avg_epu16", "avx2", "XXX" },
+        { "llvm.x86.avx2.pmadd.wd", "_mm256_madd_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.pmadd.ub.sw", "_mm256_maddubs_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.pmul.hr.sw", "_mm256_mulhrs_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.pmulh.w", "_mm256_mulhi_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.pmulhu.w", "_mm256_mulhi_epu16", "avx2", "XXX" },
+        { "llvm.x86.avx2.psad.bw", "_mm256_sad_epu8", "avx2", "XXX" },
+        { "llvm.x86.avx2.packsswb", "_mm256_packs_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.packssdw", "_mm256_packs_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.packuswb", "_mm256_packus_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.packusdw", "_mm256_packus_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.phadd.w", "_mm256_hadd_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.phadd.d", "_mm256_hadd_epi32", "avx2", "XXX" },
+        { "llvm.x86.avx2.psign.b", "_mm256_sign_epi8", "avx2", "XXX" },
+        { "llvm.x86.avx2.psign.w", "_mm256_sign_epi16", "avx2", "XXX" },
+        { "llvm.x86.avx2.psign.d", "_mm256_sign_epi32", "avx2", "XXX" },
+        { "llvm.x86.aesni.aesenc", "_mm_aesenc_si128", "aes", "xxx" },
+        { "llvm.x86.aesni.aesenclast", "_mm_aesenclast_si128", "aes", "xxx" },
+        { "llvm.x86.aesni.aesdec", "_mm_aesdec_si128", "aes", "xxx" },
+        { "llvm.x86.aesni.aesdeclast", "_mm_aesdeclast_si128", "aes", "xxx" },
+        { "llvm.x86.aesni.aesimc", "_mm_aesimc_si128", "aes", "xx" },
+        { "llvm.x86.bmi.pext.32", "_pext_u32", "bmi2", "iii" },
+        { "llvm.x86.bmi.pdep.32", "_pdep_u32", "bmi2", "iii" },
+        { "llvm.x86.bmi.pext.64", "_pext_u64", "bmi2", "iii" },
+        { "llvm.x86.bmi.pdep.64", "_pdep_u64", "bmi2", "iii" },
+    };
+    const LlvmX86Intrinsic* find_llvm_x86_intrinsic(const ::std::string& name)
+    {
+        for(const auto& e : LLVM_X86_INTRINSICS)
+        {
+            if( name == e.llvm_name )
+                return &e;
+        }
+        return nullptr;
+    }
+    const char* llvm_x86_vector_ctype(char c)
+    {
+        switch(c)
+        {
+        case 'x':   return "__m128i";
+        case 'f':   return "__m128";
+        case 'd':   return "__m128d";
+        case 'X':   return "__m256i";
+        case 'F':   return "__m256";
+        case 'D':   return "__m256d";
+        default:    return nullptr;
+        }
+    }
+
     class CodeGenerator_C:
         public CodeGenerator
     {
@@ -243,15 +508,53 @@ namespace {
 
         ::std::set< ::HIR::TypeRef> m_emitted_fn_types;
         ::std::set< const TypeRepr*>    m_embedded_tags;
+
+        /// Output units when `-C codegen-units` is above one
+        /// - `m_of` is the common header (types, prototypes) until the first function body is emitted
+        /// - Function bodies are spread across the units, balanced by MIR size
+        struct CodegenUnit
+        {
+            ::std::string   path_c;
+            ::std::ofstream of;
+            size_t  weight = 0;
+        };
+        ::std::vector<CodegenUnit>  m_units;
+        /// Storage for the header stream while a unit is swapped into `m_of`
+        ::std::ofstream m_header_of;
+        static const size_t UNIT_HEADER = SIZE_MAX;
+        size_t  m_cur_unit = UNIT_HEADER;
+        /// Unit holding each emitted function body (by symbol), aliases must be in the same unit as their target
+        ::std::map<RcString, size_t>    m_function_units;
     public:
-        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile):
+        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt):
             m_crate(crate),
             m_resolve(crate),
             m_outfile_path(outfile),
-            m_outfile_path_c(outfile + ".c"),
+            m_outfile_path_c(opt.codegen_units > 1 && Target_GetCurSpec().m_backend_c.m_codegen_mode != CodegenMode::Msvc ? outfile + ".h" : outfile + ".c"),
             m_of(m_outfile_path_c)
         {
             ASSERT_BUG(Span(), m_of.is_open(), "Failed to open `" << m_outfile_path_c << "` for writing");
+            if( opt.codegen_units > 1 )
+            {
+                if( Target_GetCurSpec().m_backend_c.m_codegen_mode == CodegenMode::Msvc )
+                {
+                    WARNING(Span(), W0000, "-C codegen-units is not supported with MSVC, using a single unit");
+                }
+                else
+                {
+                    // Units include the header by its bare name, it lives in the same directory
+                    auto header_name = m_outfile_path_c.substr(m_outfile_path_c.find_last_of("/\\") + 1);
+                    m_units.resize(opt.codegen_units);
+                    for(size_t i = 0; i < m_units.size(); i ++)
+                    {
+                        auto& u = m_units[i];
+                        u.path_c = FMT(m_outfile_path << "." << i << ".c");
+                        u.of.open(u.path_c);
+                        ASSERT_BUG(Span(), u.of.is_open(), "Failed to open `" << u.path_c << "` for writing");
+                        u.of << "#include \"" << header_name << "\"\n";
+                    }
+                }
+            }
             m_options.emulated_i128 = Target_GetCurSpec().m_backend_c.m_emulated_i128;
             switch(Target_GetCurSpec().m_backend_c.m_codegen_mode)
             {
@@ -338,6 +641,15 @@ namespace {
                     << "extern void _Unwind_Resume(void) __attribute__((noreturn));\n"
                     << "#define ALIGNOF(t) __alignof__(t)\n"
                     ;
+                // SIMD shuffles on `vector_size` types (clang's `__builtin_shufflevector` only takes constant indices)
+                m_of
+                    << "#define SIMD_SHUFFLE_LOOP(r, a, b, m) do { unsigned n_ = sizeof(a)/sizeof(a[0]); for(unsigned i_ = 0; i_ < sizeof(r)/sizeof(r[0]); i_ ++) { unsigned j_ = m[i_]; r[i_] = j_ < n_ ? a[j_] : b[j_ - n_]; } } while(0)\n"
+                    << "#ifdef __clang__\n"
+                    << "# define SIMD_SHUFFLE(r, a, b, m) SIMD_SHUFFLE_LOOP(r, a, b, m)\n"
+                    << "#else\n"
+                    << "# define SIMD_SHUFFLE(r, a, b, m) r = __builtin_shuffle(a, b, m)\n"
+                    << "#endif\n"
+                    ;
                 break;
             case Compiler::Msvc:
                 m_of
@@ -785,15 +1097,6 @@ namespace {
                 << "static inline size_t mrustc_max(size_t a, size_t b) { return a < b ? b : a; }\n"
                 << "static inline void noop_drop(tUNIT *p) { }\n"
                 << "\n"
-                // A linear (fast-fail) search of a list of strings
-                << "static inline size_t mrustc_string_search_linear(SLICE_PTR val, size_t count, SLICE_PTR* options) {\n"
-                << "\tfor(size_t i = 0; i < count; i ++) {\n"
-                << "\t\tint cmp = slice_cmp(val, options[i]);\n"
-                << "\t\tif(cmp < 0) break;\n"
-                << "\t\tif(cmp == 0) return i;\n"
-                << "\t}\n"
-                << "\treturn SIZE_MAX;\n"
-                << "}\n"
                 // Map of reversed nibbles                       0  1  2  3  4  5  6  7   8  9 10 11 12 14 15
                 << "static const uint8_t __mrustc_revmap[16] = { 0, 8, 4,12, 2,10, 6,14,  1, 9, 5,13, 3, 7,15};\n"
                 << "static inline uint8_t __mrustc_bitrev8(uint8_t v) { if(v==0||v==0xFF) return v; return __mrustc_revmap[v>>4]|(__mrustc_revmap[v&15]<<4); }\n"
@@ -829,10 +1132,94 @@ namespace {
 
         ~CodeGenerator_C() {}
 
+        /// Swap the requested unit (or the common header) into `m_of`
+        void select_unit(size_t idx)
+        {
+            if( m_units.empty() || idx == m_cur_unit )
+                return ;
+            auto home = [&](size_t i)->::std::ofstream& { return i == UNIT_HEADER ? m_header_of : m_units[i].of; };
+            ::std::swap(m_of, home(m_cur_unit));
+            ::std::swap(m_of, home(idx));
+            m_cur_unit = idx;
+        }
+        /// Pick the least-loaded unit for a function body of the given size
+        void select_unit_for_function(size_t weight)
+        {
+            if( m_units.empty() )
+                return ;
+            size_t best = 0;
+            for(size_t i = 1; i < m_units.size(); i ++)
+            {
+                if( m_units[i].weight < m_units[best].weight )
+                    best = i;
+            }
+            m_units[best].weight += weight;
+            select_unit(best);
+        }
+        /// Linkage for items that are local to this crate but may be referenced from any unit
+        /// (e.g. local copies of functions from other crates)
+        void emit_crate_local_linkage()
+        {
+            if( m_units.empty() ) {
+                m_of << "static ";
+            }
+            else {
+                // Every crate emits an identical copy, so let the linker pick one.
+                m_of << "__attribute__((weak,visibility(\"hidden\"))) ";
+            }
+        }
+        /// Linkage for a function from another crate (i.e. a monomorphised instance of an upstream generic)
+        void emit_extern_def_linkage(const ::HIR::Path& p)
+        {
+            if( has_shared_export(p, true) ) {
+                // The body is only referenced from this crate (under `shared_local_symbol`), so doesn't need to be weak
+                if( m_units.empty() ) {
+                    m_of << "static ";
+                }
+                else {
+                    m_of << "__attribute__((visibility(\"hidden\"))) ";
+                }
+            }
+            else if( m_crate.m_shared_instances.count(Trans_Mangle(p).c_str()) ) {
+                // No aliases (Mach-O), so the body itself is exported. Weak as sibling crates may share the same instance
+                m_of << "__attribute__((weak)) ";
+            }
+            else {
+                emit_crate_local_linkage();
+            }
+        }
+        /// Check if this is an upstream generic instance shared with downstream crates, emitted as a local body and an exported weak alias
+        /// - A weak definition can be replaced at link time, so GCC won't inline it. Keeping the body local avoids that.
+        bool has_shared_export(const ::HIR::Path& p, bool is_extern_def) const
+        {
+            return is_extern_def
+                && m_compiler == Compiler::Gcc && Target_GetCurSpec().m_os_name != "macos"
+                && m_crate.m_shared_instances.count(Trans_Mangle(p).c_str());
+        }
+        /// Assembler name for the local body of a shared instance (qualified by crate, as units can make it non-static)
+        ::std::string shared_local_symbol(const ::HIR::Path& p) const
+        {
+            ::std::string rv = Trans_Mangle(p).c_str();
+            rv += ".local.";
+            for(const char* c = m_crate.m_crate_name.c_str(); *c; c ++)
+                rv += (isalnum(static_cast<unsigned char>(*c)) ? *c : '_');
+            return rv;
+        }
+        /// Export a shared instance under its mangled name, as a weak alias of the local body
+        void emit_shared_export(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params)
+        {
+            m_of << "__attribute__((weak,alias(\"" << shared_local_symbol(p) << "\"))) ";
+            emit_function_header(p, item, params, "__shared");
+            m_of << " __asm__(\"" << Trans_Mangle(p) << "\");\n";
+        }
+
         void finalise(const TransOptions& opt, CodegenOutput out_ty, const ::std::string& hir_file) override
         {
             const bool create_shims = (out_ty == CodegenOutput::Executable);
 
+            // Shims and `main` live in the first unit
+            select_unit(0);
+
             // TODO: Support dynamic libraries too
             // - No main, but has the rest.
             // - Well... for cdylibs that's the case, for rdylibs it's not
@@ -1014,9 +1401,16 @@ namespace {
                 }
             }
 
+            select_unit(UNIT_HEADER);
             m_of.flush();
             m_of.close();
             ASSERT_BUG(Span(), !m_of.bad(), "Error set on output stream for: " << m_outfile_path_c);
+            for(auto& u : m_units)
+            {
+                u.of.flush();
+                u.of.close();
+                ASSERT_BUG(Span(), !u.of.bad(), "Error set on output stream for: " << u.path_c);
+            }
 
             class LinkList: private StringList
             {
@@ -1252,9 +1646,9 @@ namespace {
             bool is_windows = false;
 #endif
             size_t  arg_file_start = 0;
-            switch( m_compiler )
-            {
-            case Compiler::Gcc:
+            // Compiler and code generation flags (shared by the per-unit compiles)
+            // - Returns the index of the first argument that can go in an argument file
+            auto push_gcc_compile_args = [&](StringList& args)->size_t {
                 // Pick the compiler
                 // - from `CC_${TRIPLE}` environment variable, with all '-' in TRIPLE replaced by '_'
                 // - from the `CC` environment variable
@@ -1277,12 +1671,13 @@ namespace {
                         args.push_back("gcc");
                     }
                 }
-                arg_file_start = args.get_vec().size();
+                size_t rv = args.get_vec().size();
                 for( const auto& a : Target_GetCurSpec().m_backend_c.m_compiler_opts )
                 {
                     args.push_back( a.c_str() );
                 }
                 args.push_back("-Wno-psabi");   // Suppress "note: the ABI for passing parameters with 128-byte alignment has changed in GCC 4.6"
+                args.push_back("-Wno-attribute-alias");   // Merged instances alias functions that differ only in zero-sized types
                 switch(opt.opt_level)
                 {
                 case 0: break;
@@ -1305,6 +1700,25 @@ namespace {
                 }
                 // TODO: Why?
                 args.push_back("-fPIC");
+                return rv;
+                };
+            // Commands for each codegen unit, run in parallel before the final compile/link
+            ::std::vector<::std::string>    unit_commands;
+            switch( m_compiler )
+            {
+            case Compiler::Gcc:
+                for(size_t i = 0; i < m_units.size(); i ++)
+                {
+                    StringList  unit_args;
+                    auto unit_arg_file_start = push_gcc_compile_args(unit_args);
+                    unit_args.push_back("-c");
+                    unit_args.push_back("-o");
+                    unit_args.push_back(FMT(m_outfile_path << "." << i << ".o"));
+                    unit_args.push_back(m_units[i].path_c.c_str());
+                    unit_commands.push_back( make_command(unit_args, unit_arg_file_start, FMT(m_outfile_path << "." << i << "_cmd.txt"), is_windows) );
+                }
+
+                arg_file_start = push_gcc_compile_args(args);
                 args.push_back("-o");
                 switch(out_ty)
                 {
@@ -1317,7 +1731,15 @@ namespace {
                     args.push_back(m_outfile_path+".o");
                     break;
                 }
-                args.push_back(m_outfile_path_c.c_str());
+                if( m_units.empty() )
+                {
+                    args.push_back(m_outfile_path_c.c_str());
+                }
+                else
+                {
+                    for(size_t i = 0; i < m_units.size(); i ++)
+                        args.push_back(FMT(m_outfile_path << "." << i << ".o"));
+                }
                 switch(out_ty)
                 {
                 case CodegenOutput::DynamicLibrary:
@@ -1366,7 +1788,16 @@ namespace {
                     break;
                 case CodegenOutput::StaticLibrary:
                 case CodegenOutput::Object:
-                    args.push_back("-c");
+                    if( m_units.empty() )
+                    {
+                        args.push_back("-c");
+                    }
+                    else
+                    {
+                        // Combine the unit objects into the single object that downstream crates expect
+                        args.push_back("-r");
+                        args.push_back("-nostdlib");
+                    }
                     break;
                 }
                 break;
@@ -1461,53 +1892,36 @@ namespace {
                 break;
             }
 
-            ::std::stringstream cmd_ss;
-            if (is_windows)
-            {
-                cmd_ss << "echo \"\" & ";
-            }
-            std::string command_file = m_outfile_path + "_cmd.txt";
-            std::ofstream   command_file_stream;
-            if( getenv("MRUSTC_CCACHE") ) {
-                cmd_ss << "ccache ";
-            }
-            bool use_arg_file = arg_file_start > 0;
-            if(use_arg_file) {
-                command_file_stream.open(command_file);
-                ASSERT_BUG(Span(), command_file_stream.is_open(), "Failed to open command file `" << command_file << "` for writing");
-            }
-            size_t i = -1;
-            for(const auto& arg : args.get_vec())
+            auto cmd = make_command(args, arg_file_start, m_outfile_path + "_cmd.txt", is_windows);
+            //DEBUG("- " << cmd);
+            for(const auto& c : unit_commands)
             {
-                i ++;
-                auto& out_ss = (use_arg_file && i >= arg_file_start ? static_cast<::std::ostream&>(command_file_stream) : cmd_ss);
-                if(strcmp(arg, "&") == 0 && is_windows) {
-                    out_ss << "&";
-                }
-                else {
-                    if( is_windows && strchr(arg, ' ') == nullptr ) {
-                        out_ss << arg << " ";
-                    }
-                    else {
-                        out_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
-                    }
-                }
-            }
-            if(use_arg_file) {
-                cmd_ss << "@\"" << FmtShell(command_file, is_windows) << "\"";
-                command_file_stream.close();
-                ASSERT_BUG(Span(), !command_file_stream.bad(), "Error set on output stream for: " << m_outfile_path_c);
+                ::std::cout << "Running command - " << c << ::std::endl;
             }
-            //DEBUG("- " << cmd_ss.str());
-            ::std::cout << "Running command - " << cmd_ss.str() << ::std::endl;
+            ::std::cout << "Running command - " << cmd << ::std::endl;
             if( opt.build_command_file != "" )
             {
-                ::std::cerr << "INVOKE CC: " << cmd_ss.str() << ::std::endl;
-                ::std::ofstream(opt.build_command_file) << cmd_ss.str() << ::std::endl;
+                ::std::ofstream os(opt.build_command_file);
+                for(const auto& c : unit_commands)
+                {
+                    ::std::cerr << "INVOKE CC: " << c << ::std::endl;
+                    os << c << ::std::endl;
+                }
+                ::std::cerr << "INVOKE CC: " << cmd << ::std::endl;
+                os << cmd << ::std::endl;
             }
             else
             {
-                int ec = system(cmd_ss.str().c_str());
+                if( !unit_commands.empty() )
+                {
+                    int ec = run_commands_parallel(unit_commands);
+                    if( ec != 0 )
+                    {
+                        ::std::cerr << "C Compiler failed to execute - error code " << ec << ::std::endl;
+                        exit(1);
+                    }
+                }
+                int ec = system(cmd.c_str());
                 if( ec == -1 )
                 {
                     ::std::cerr << "C Compiler failed to execute (system returned -1)" << ::std::endl;
@@ -1600,6 +2014,7 @@ namespace {
 
         void emit_global_asm(const ::HIR::GlobalAssembly& se) override
         {
+            select_unit(0);
             m_of << "__asm__ (\"";
             if( (Target_GetCurSpec().m_arch.m_name == "x86" || Target_GetCurSpec().m_arch.m_name == "x86_64") && !se.m_options.att_syntax )
                 m_of << ".intel_syntax noprefix; ";
@@ -2389,6 +2804,10 @@ namespace {
             if(item.m_linkage.type == HIR::Linkage::Type::ExternWeak) {
                 ASSERT_BUG(sp, linkage_name != "", "");
                 m_of << "extern char " << linkage_name << "[0];\n";
+                if( !m_units.empty() ) {
+                    // Only holds the address, so a per-unit copy is fine
+                    m_of << "static ";
+                }
                 emit_static_ty(type, p, /*is_proto=*/true);
                 m_of << " = { .raw = { (uintptr_t)" << linkage_name << " } };";
                 m_of << "\t// static " << p << " : " << type;
@@ -2471,6 +2890,10 @@ namespace {
             if( item.m_params.is_generic() ) {
                 m_of << "static ";
             }
+            else if( !m_units.empty() ) {
+                // Defined in the first unit (this is a shared header)
+                m_of << "extern ";
+            }
             emit_static_ty(type, p, /*is_proto=*/true);
             m_of << ";";
             m_of << "\t// static " << p << " : " << type;
@@ -2487,8 +2910,15 @@ namespace {
             TRACE_FUNCTION_F(p);
 
             auto type = params.monomorph(m_resolve, item.m_type);
+            // Generic statics are internal to each unit, so stay in the header. Everything else is defined once.
+            select_unit(item.m_params.is_generic() ? UNIT_HEADER : 0);
             // statics that are zero do not require initializers, since they will be initialized to zero on program startup.
-            if( !is_zero_literal(type, encoded, params)) {
+            if( !m_units.empty() && !item.m_params.is_generic() && is_zero_literal(type, encoded, params) ) {
+                // - But the header only has an `extern` declaration, so emit the definition
+                emit_static_ty(type, p, /*is_proto=*/false);
+                m_of << ";\n";
+            }
+            else if( !is_zero_literal(type, encoded, params)) {
                 if( item.m_params.is_generic() ) {
                     m_of << "static ";
                 }
@@ -2671,7 +3101,17 @@ namespace {
             // For MSVC, make a static wrapper that goes and calls the actual function
             if( item.m_linkage.name.rfind("llvm.", 0) == 0 )
             {
-                m_of << "static ";
+                const auto* x86_intrinsic = find_llvm_x86_intrinsic(item.m_linkage.name);
+                if( x86_intrinsic && m_compiler == Compiler::Gcc )
+                {
+                    // Include here (instead of in the prelude) so only code using x86 intrinsics pays for the header
+                    m_of << "#include <immintrin.h>\n";
+                    m_of << "static __attribute__((target(\"" << x86_intrinsic->target << "\"))) ";
+                }
+                else
+                {
+                    m_of << "static ";
+                }
                 emit_function_header(p, item, params);
                 m_of
                     << "{\n"
@@ -2685,39 +3125,36 @@ namespace {
                     msvc_suffix_u32 = "_u32";
                 }
 
-                // pshufb instruction w/ 128 bit operands
-                if( item.m_linkage.name == "llvm.x86.ssse3.pshuf.b.128" ) {
-                    m_of
-                        << "\tconst uint8_t* src = (const uint8_t*)&arg0;\n"
-                        << "\tconst uint8_t* mask = (const uint8_t*)&arg1;\n"
-                        << "\tuint8_t* dst = (uint8_t*)&rv;\n"
-                        << "\tfor(int i = 0; i < " << 128/8 << "; i ++) dst[i] = (mask[i] < 0x80 ? src[i] : 0);\n"
-                        << "\treturn rv;\n"
-                        ;
-                }
-                else if( item.m_linkage.name == "llvm.x86.sse2.psrli.d") {
-                    m_of
-                        << "\tconst uint32_t* src = (const uint32_t*)&arg0;\n"
-                        << "\tuint32_t* dst = (uint32_t*)&rv;\n"
-                        << "\tfor(int i = 0; i < " << 128/32 << "; i ++) dst[i] = src[i] >> arg1;\n"
-                        << "\treturn rv;\n"
-                        ;
-                }
-                else if( item.m_linkage.name == "llvm.x86.sse2.pslli.d") {
-                    m_of
-                        << "\tconst uint32_t* src = (const uint32_t*)&arg0;\n"
-                        << "\tuint32_t* dst = (uint32_t*)&rv;\n"
-                        << "\tfor(int i = 0; i < " << 128/32 << "; i ++) dst[i] = src[i] << arg1;\n"
-                        << "\treturn rv;\n"
-                        ;
-                }
-                else if( item.m_linkage.name == "llvm.x86.sse2.pmovmskb.128") {
-                    m_of
-                        << "\tconst uint8_t* src = (const uint8_t*)&arg0;\n"
-                        << "\tuint8_t* dst = (uint8_t*)&rv; *dst = 0;\n"
-                        << "\tfor(int i = 0; i < " << 128/8 << "; i ++) *dst |= (src[i] >> 7) << i;\n"
-                        << "\treturn rv;\n"
-                        ;
+                if( x86_intrinsic ) {
+                    const char* sig = x86_intrinsic->sig;
+                    MIR_ASSERT(*m_mir_res, strlen(sig) == 1 + item.m_args.size(),
+                        "Argument count mismatch for " << item.m_linkage.name << " - expected " << strlen(sig)-1 << ", got " << item.m_args.size());
+                    // Vector arguments are copied into the intrinsic's own types (rust's are structs)
+                    for(size_t i = 0; i < item.m_args.size(); i ++)
+                    {
+                        if( const auto* vty = llvm_x86_vector_ctype(sig[1+i]) ) {
+                            auto ty = params.monomorph(m_resolve, item.m_args[i].second);
+                            m_of << "\t" << vty << " v" << i << "; memcpy(&v" << i << ", " << (type_is_high_align(ty) ? "" : "&") << "arg" << i << ", sizeof(v" << i << "));\n";
+                        }
+                    }
+                    m_of << "\t";
+                    if( const auto* vty = llvm_x86_vector_ctype(sig[0]) ) {
+                        m_of << vty << " vr = ";
+                    }
+                    else if( sig[0] == 'i' ) {
+                        m_of << "rv = ";
+                    }
+                    m_of << x86_intrinsic->c_name << "(";
+                    for(size_t i = 0; i < item.m_args.size(); i ++)
+                    {
+                        if(i > 0)   m_of << ", ";
+                        m_of << (llvm_x86_vector_ctype(sig[1+i]) ? "v" : "arg") << i;
+                    }
+                    m_of << ");\n";
+                    if( llvm_x86_vector_ctype(sig[0]) ) {
+                        m_of << "\tmemcpy(&rv, &vr, sizeof(rv));\n";
+                    }
+                    m_of << "\treturn" << (sig[0] == 'v' ? "" : " rv") << ";\n";
                 }
                 else if( item.m_linkage.name == "llvm.x86.sse2.storeu.dq" ) {
                     m_of << "\tmemcpy(arg0, &arg1, sizeof(arg1));\n";
@@ -2754,20 +3191,6 @@ namespace {
                         break;
                     }
                 }
-                else if( item.m_linkage.name == "llvm.x86.sse2.pause" ) {
-                    // Just a `PAUSE` instruciton, which is effectively a nop
-                    switch(m_compiler)
-                    {
-                    case Compiler::Gcc  : m_of << "\t__asm__ __volatile__ (\"pause\");\n";    break;
-                    case Compiler::Msvc : m_of << "\t_mm_pause();\n"; break;
-                    }
-                    m_of << "\treturn ;\n";
-                }
-                // AES functions
-                else if( item.m_linkage.name.rfind("llvm.x86.aesni.", 0) == 0 )
-                {
-                    m_of << "\tassert(!\"Unsupprorted LLVM x86 intrinsic: " << item.m_linkage.name << "\"); abort();\n";
-                }
                 else {
                     // TODO: Hand off to compiler-specific intrinsics
                     //MIR_TODO(*m_mir_res, "LLVM extern linkage: " << item.m_linkage.name);
@@ -2841,7 +3264,7 @@ namespace {
             }
             if( is_extern_def )
             {
-                m_of << "static ";
+                emit_extern_def_linkage(p);
             }
             switch(item.m_linkage.type)
             {
@@ -2864,10 +3287,46 @@ namespace {
                 BUG(Span(), "unexpected ExternWeak on function");
             }
             emit_function_header(p, item, params);
+            if( has_shared_export(p, is_extern_def) ) {
+                m_of << " __asm__(\"" << shared_local_symbol(p) << "\")";
+            }
             m_of << ";\n";
 
             m_mir_res = nullptr;
         }
+        void emit_function_alias(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::HIR::Path& target, const ::MIR::FunctionPointer& code) override
+        {
+            // Mach-O and MSVC don't support `alias`
+            if( m_compiler != Compiler::Gcc || Target_GetCurSpec().m_os_name == "macos" ) {
+                emit_function_code(p, item, params, is_extern_def, code);
+                return ;
+            }
+            TRACE_FUNCTION_F(p << " = " << target);
+            auto target_name = Trans_Mangle(target);
+            if( !m_units.empty() )
+            {
+                select_unit(m_function_units.at(target_name));
+            }
+            // Aliases refer to the assembler name, so use the local body's name for shared instances
+            // - `target` is an instance of the same function, so `is_extern_def` applies to it too
+            ::std::string target_sym = has_shared_export(target, is_extern_def) ? shared_local_symbol(target) : target_name.c_str();
+
+            ::MIR::Function empty_fcn;
+            ::MIR::TypeResolve  top_mir_res { sp, m_resolve, FMT_CB(ss, ss << "/*alias*/ fn " << p;), ::HIR::TypeRef(), {}, empty_fcn };
+            m_mir_res = &top_mir_res;
+
+            m_of << "// " << p << " = " << target << "\n";
+            if( is_extern_def ) {
+                emit_extern_def_linkage(p);
+            }
+            emit_function_header(p, item, params);
+            m_of << " __attribute__((alias(\"" << target_sym << "\")));\n";
+            if( has_shared_export(p, is_extern_def) ) {
+                emit_shared_export(p, item, params);
+            }
+
+            m_mir_res = nullptr;
+        }
         void emit_function_code(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::MIR::FunctionPointer& code) override
         {
             TRACE_FUNCTION_F(p);
@@ -2882,9 +3341,18 @@ namespace {
             ::MIR::TypeResolve  mir_res { sp, m_resolve, FMT_CB(ss, ss << p;), ret_type, arg_types, *code };
             m_mir_res = &mir_res;
 
+            if( !m_units.empty() )
+            {
+                size_t weight = code->blocks.size();
+                for(const auto& bb : code->blocks)
+                    weight += bb.statements.size();
+                select_unit_for_function(weight);
+                m_function_units[Trans_Mangle(p)] = m_cur_unit;
+            }
+
             m_of << "// " << p << "\n";
             if( is_extern_def ) {
-                m_of << "static ";
+                emit_extern_def_linkage(p);
             }
             emit_function_header(p, item, params);
             m_of << "\n";
@@ -3265,6 +3733,9 @@ namespace {
                 m_of << "#endif\n";
             }
             m_of << "}\n";
+            if( has_shared_export(p, is_extern_def) ) {
+                emit_shared_export(p, item, params);
+            }
             m_of.flush();
             m_mir_res = nullptr;
         }
@@ -4436,13 +4907,52 @@ namespace {
             ::HIR::TypeRef  tmp;
             const auto& ty = mir_res.get_lvalue_type(tmp, val);
             if( const auto* ve = values.opt_String() ) {
-                m_of << indent << "{ static SLICE_PTR switch_strings[] = {";
-                for(const auto& v : *ve)
+                // Find the matching index by switching on the length, then on the byte that best separates the
+                // options of that length, with a final `memcmp` (instead of comparing against each option in turn)
+                ::std::map<size_t, ::std::vector<size_t>>   by_len;
+                for(size_t i = 0; i < ve->size(); i++)
+                    by_len[(*ve)[i].size()].push_back(i);
+
+                m_of << indent << "{ SLICE_PTR switch_str = "; emit_lvalue(val); m_of << "; size_t switch_idx = SIZE_MAX;\n";
+                m_of << indent << "switch( switch_str.META ) {\n";
+                for(const auto& l : by_len)
                 {
-                    m_of << " {"; this->print_escaped_string(v); m_of << "," << v.size() << "},";
+                    const auto len = l.first;
+                    m_of << indent << "case " << len << ": ";
+                    if( len == 0 ) {
+                        m_of << "switch_idx = " << l.second.front() << "; break;\n";
+                        continue;
+                    }
+                    size_t best_ofs = 0;
+                    size_t best_count = 0;
+                    for(size_t ofs = 0; ofs < len && best_count < l.second.size(); ofs ++)
+                    {
+                        ::std::set<uint8_t> seen;
+                        for(auto i : l.second)
+                            seen.insert( static_cast<uint8_t>((*ve)[i][ofs]) );
+                        if( seen.size() > best_count ) {
+                            best_count = seen.size();
+                            best_ofs = ofs;
+                        }
+                    }
+                    ::std::map<uint8_t, ::std::vector<size_t>>  by_byte;
+                    for(auto i : l.second)
+                        by_byte[ static_cast<uint8_t>((*ve)[i][best_ofs]) ].push_back(i);
+
+                    m_of << "switch( ((const uint8_t*)switch_str.PTR)[" << best_ofs << "] ) {\n";
+                    for(const auto& b : by_byte)
+                    {
+                        m_of << indent << "\tcase " << unsigned(b.first) << ":";
+                        for(auto i : b.second)
+                        {
+                            m_of << " if( memcmp(switch_str.PTR, "; this->print_escaped_string((*ve)[i]); m_of << ", " << len << ") == 0 ) switch_idx = " << i << "; else";
+                        }
+                        m_of << " {} break;\n";
+                    }
+                    m_of << indent << "\t} break;\n";
                 }
-                m_of << " {0,0} };\n";
-                m_of << indent << "switch( mrustc_string_search_linear("; emit_lvalue(val); m_of << ", " << ve->size() << ", switch_strings) ) {\n";
+                m_of << indent << "}\n";
+                m_of << indent << "switch( switch_idx ) {\n";
                 for(size_t i = 0; i < ve->size(); i++)
                 {
                     m_of << indent << "case " << i << ": "; cb(i); m_of << " break;\n";
@@ -5584,7 +6094,7 @@ namespace {
             }
         }
 
-        void emit_function_header(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params)
+        void emit_function_header(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, const char* name_suffix="")
         {
             ::HIR::TypeRef  tmp;
             const auto& ret_ty = monomorphise_fcn_return(tmp, item, params);
@@ -5594,7 +6104,7 @@ namespace {
                 {
                     ss << " __stdcall";
                 }
-                ss << " " << Trans_Mangle(p) << "(";
+                ss << " " << Trans_Mangle(p) << name_suffix << "(";
                 if( item.m_args.size() == 0 )
                 {
                     ss << "void)";
@@ -7289,12 +7799,35 @@ namespace {
                         case Unsigned:  self.m_of << "uint" << (item_size*8) << "_t";   break;
                         }
                     }
+                    /// Can this be handled as a GCC vector extension type (`vector_size` must be a power of two)
+                    bool can_vectorise(const CodeGenerator_C& self) const {
+                        return self.m_compiler == Compiler::Gcc && count > 1 && (count & (count - 1)) == 0;
+                    }
+                    /// Emit a block-local `vector_size` typedef matching this SIMD type
+                    void emit_vec_typedef(CodeGenerator_C& self, const char* name) {
+                        self.m_of << "typedef "; emit_val_ty(self); self.m_of << " " << name << " __attribute__((vector_size(" << (count * item_size) << "))); ";
+                    }
                 };
+                // Copy between the struct representation of a SIMD type and a local vector (compiles down to a register move)
+                auto load_vec = [&](const char* dst, const ::MIR::Param& src) {
+                    m_of << "memcpy(&" << dst << ", &"; emit_param(src); m_of << ", sizeof(" << dst << ")); ";
+                    };
+                auto store_vec = [&](const char* src) {
+                    m_of << "memcpy(&"; emit_lvalue(e.ret_val); m_of << ", &" << src << ", sizeof(" << src << ")); ";
+                    };
 
                 auto simd_cmp = [&](const char* op) {
                     auto src_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto dst_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, src_info.count == dst_info.count, "Element counts must match for " << name);
+                    if( src_info.can_vectorise(*this) && src_info.item_size == dst_info.item_size ) {
+                        // GCC vector comparisons produce 0/-1 in a signed integer vector of the same element size
+                        m_of << "{ "; src_info.emit_vec_typedef(*this, "VS"); dst_info.emit_vec_typedef(*this, "VD");
+                        m_of << "VS a, b; "; load_vec("a", e.args.at(0)); load_vec("b", e.args.at(1));
+                        m_of << "VD r = (VD)(a " << op << " b); "; store_vec("r");
+                        m_of << "}";
+                        return ;
+                    }
                     m_of << "for(int i = 0; i < " << dst_info.count << "; i++)";
                     m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
                     m_of << "= (";
@@ -7305,6 +7838,13 @@ namespace {
                     };
                 auto simd_arith = [&](const char* op) {
                     auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    if( info.can_vectorise(*this) ) {
+                        m_of << "{ "; info.emit_vec_typedef(*this, "V");
+                        m_of << "V a, b; "; load_vec("a", e.args.at(0)); load_vec("b", e.args.at(1));
+                        m_of << "a " << op << "= b; "; store_vec("a");
+                        m_of << "}";
+                        return ;
+                    }
                     // Emulate!
                     emit_lvalue(e.ret_val); m_of << " = "; emit_param(e.args.at(0)); m_of << "; ";
                     m_of << "for(int i = 0; i < " << info.count << "; i++)";
@@ -7320,6 +7860,36 @@ namespace {
                     m_of << "= " << op << "( (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i] )";
                     };
 
+                // Shuffle `count_out` entries from the concatenation of the first two arguments, indexed by the third (an array of u32)
+                auto simd_shuffle = [&](const ::HIR::TypeRef& vec_ty, const ::HIR::TypeRef& ret_ty, size_t count_out) {
+                    size_t size_in = 0;
+                    size_t size_out = 0;
+                    Target_GetSizeOf(sp, m_resolve, vec_ty, size_in);
+                    Target_GetSizeOf(sp, m_resolve, ret_ty, size_out);
+                    size_t size_val = size_out / count_out;
+                    MIR_ASSERT(mir_res, size_val > 0, size_out << " / " << count_out << " == 0?");
+                    MIR_ASSERT(mir_res, size_out / size_val * size_val == size_out, size_out << " not a multiple of " << size_val);
+                    MIR_ASSERT(mir_res, size_in / size_val * size_val == size_in, size_in << " not a multiple of " << size_val);
+                    size_t count_in = size_in / size_val;
+                    SimdInfo    in_info { static_cast<unsigned>(count_in), static_cast<unsigned>(size_val), SimdInfo::Unsigned };
+                    SimdInfo    out_info { static_cast<unsigned>(count_out), static_cast<unsigned>(size_val), SimdInfo::Unsigned };
+                    if( in_info.can_vectorise(*this) && out_info.can_vectorise(*this) ) {
+                        m_of << "{ "; in_info.emit_vec_typedef(*this, "VI"); out_info.emit_vec_typedef(*this, "VO");
+                        m_of << "VI a, b; VO m, r; "; load_vec("a", e.args.at(0)); load_vec("b", e.args.at(1));
+                        m_of << "for(int i = 0; i < " << count_out << "; i++) m[i] = "; emit_param(e.args.at(2)); m_of << ".DATA[i]; ";
+                        // `SIMD_SHUFFLE` (see prelude) is `__builtin_shuffle` on GCC, which needs matching element counts
+                        m_of << (count_in == count_out ? "SIMD_SHUFFLE" : "SIMD_SHUFFLE_LOOP") << "(r, a, b, m); ";
+                        store_vec("r");
+                        m_of << "}";
+                        return ;
+                    }
+                    m_of << "for(int i = 0; i < " << count_out << "; i++) {";
+                    m_of << " int j = "; emit_param(e.args.at(2)); m_of << ".DATA[i];";
+                    m_of << " ((uint" << (size_val*8) << "_t*)&"; emit_lvalue(e.ret_val); m_of << ")[i]";
+                    m_of << " = ((uint" << (size_val*8) << "_t*)(j < " << count_in << " ? &"; emit_param(e.args.at(0)); m_of << " : &"; emit_param(e.args.at(1)); m_of << "))[j % " << count_in << "];";
+                    m_of << "}";
+                    };
+
                 // dst: T, index: usize, val: U
                 // Insert a value at position
                 if( name == "platform:simd_insert" ) {
@@ -7363,9 +7933,6 @@ namespace {
                         name == "platform:simd_shuffle4" ||
                         name == "platform:simd_shuffle2"
                         ) {
-                    // Shuffle in 8 entries
-                    size_t size_slot = 0;
-                    Target_GetSizeOf(sp, m_resolve, params.m_types.at(1), size_slot);
                     size_t div =
                         name == "platform:simd_shuffle128" ? 128 :
                         name == "platform:simd_shuffle64" ? 64 :
@@ -7376,52 +7943,51 @@ namespace {
                         name == "platform:simd_shuffle2" ? 2 :
                         throw ""
                         ;
-                    size_t size_val = size_slot / div;
-                    MIR_ASSERT(mir_res, size_val > 0, size_slot << " / " << div << " == 0?");
-                    MIR_ASSERT(mir_res, size_slot >= size_val, size_slot << " < " << size_val);
-                    MIR_ASSERT(mir_res, size_slot / size_val * size_val == size_slot, size_slot << " not a multiple of " << size_val);
-                    m_of << "for(int i = 0; i < " << div << "; i++) { int j = "; emit_param(e.args.at(2)); m_of << ".DATA[i];";
-                    m_of << "((uint" << (size_val*8) << "_t*)&"; emit_lvalue(e.ret_val); m_of << ")[i]";
-                    m_of << " = ((uint" << (size_val*8) << "_t*)(j < " << div << " ? &"; emit_param(e.args.at(1)); m_of << " : &"; emit_param(e.args.at(1)); m_of << "))[j % " << div << "];";
-                    m_of << "}";
+                    simd_shuffle(params.m_types.at(0), params.m_types.at(1), div);
                 }
                 else if( name == "platform:simd_shuffle" ) {
-                    //const auto& vec_ty = params.m_types.at(0);
                     const auto& map_ty = params.m_types.at(1);
-                    const auto& ret_ty = params.m_types.at(2);
-                    //size_t size_vec = 0;
                     size_t size_map = 0;
-                    size_t size_ret = 0;
-                    //Target_GetSizeOf(sp, m_resolve, vec_ty, size_vec);
                     Target_GetSizeOf(sp, m_resolve, map_ty, size_map);
-                    Target_GetSizeOf(sp, m_resolve, ret_ty, size_ret);
-                    size_t div = size_map / 4;  // map must be u32s
-                    size_t size_val = size_ret / div;
-                    m_of << "for(int i = 0; i < " << div << "; i++) {";
-                    m_of << " int j = "; emit_param(e.args.at(2)); m_of << ".DATA[i];";
-                    m_of << " ((uint" << (size_val*8) << "_t*)&"; emit_lvalue(e.ret_val); m_of << ")[i]";
-                    m_of << " = ((uint" << (size_val*8) << "_t*)(j < " << div << " ? &"; emit_param(e.args.at(1)); m_of << " : &"; emit_param(e.args.at(1)); m_of << "))[j % " << div << "];";
-                    m_of << "}";
+                    simd_shuffle(params.m_types.at(0), params.m_types.at(2), size_map / 4);  // map must be u32s
                 }
                 else if( name == "platform:simd_cast" ) {
                     auto src_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto dst_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, src_info.count == dst_info.count, "Element counts must match for " << name);
-                    m_of << "for(int i = 0; i < " << dst_info.count << "; i++) ";
-                    m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
-                    m_of << "= (("; src_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i];";
+                    if( src_info.can_vectorise(*this) ) {
+                        m_of << "{ "; src_info.emit_vec_typedef(*this, "VS"); dst_info.emit_vec_typedef(*this, "VD");
+                        m_of << "VS a; "; load_vec("a", e.args.at(0));
+                        m_of << "VD r = __builtin_convertvector(a, VD); "; store_vec("r");
+                        m_of << "}";
+                    }
+                    else {
+                        m_of << "for(int i = 0; i < " << dst_info.count << "; i++) ";
+                        m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
+                        m_of << "= (("; src_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i];";
+                    }
                 }
                 // Select between two values
                 else if(name == "platform:simd_select") {
                     auto mask_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto val_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, mask_info.count == val_info.count, "Element counts must match for " << name);
-                    m_of << "for(int i = 0; i < " << val_info.count << "; i++) ";
-                    m_of << "(("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
-                    m_of << "= (("; mask_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i]";
-                    m_of << "? (("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(1)); m_of << ")[i]";
-                    m_of << ": (("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(2)); m_of << ")[i]";
-                    m_of << ";";
+                    if( val_info.can_vectorise(*this) && mask_info.item_size == val_info.item_size ) {
+                        // Blend via bit operations on unsigned vectors (the `?:` operator only accepts vectors in C++)
+                        SimdInfo    bits_info { val_info.count, val_info.item_size, SimdInfo::Unsigned };
+                        m_of << "{ "; bits_info.emit_vec_typedef(*this, "VU");
+                        m_of << "VU m, a, b; "; load_vec("m", e.args.at(0)); load_vec("a", e.args.at(1)); load_vec("b", e.args.at(2));
+                        m_of << "m = (VU)(m != 0); a = (a & m) | (b & ~m); "; store_vec("a");
+                        m_of << "}";
+                    }
+                    else {
+                        m_of << "for(int i = 0; i < " << val_info.count << "; i++) ";
+                        m_of << "(("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
+                        m_of << "= (("; mask_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i]";
+                        m_of << "? (("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(1)); m_of << ")[i]";
+                        m_of << ": (("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(2)); m_of << ")[i]";
+                        m_of << ";";
+                    }
                 }
                 else if(name == "platform:simd_select_bitmask") {
                     auto val_info = SimdInfo::for_ty(*this, params.m_types.at(1));
@@ -8151,7 +8717,7 @@ namespace {
     Span CodeGenerator_C::sp;
 }
 
-::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile)
+::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt)
 {
-    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile));
+    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile, opt));
 }
@@ -21,7 +21,15 @@
 #include "mangling.hpp"
 #include <unordered_set>
 
+bool g_trans_share_generics = true;
+
 namespace {
+    /// Sharing relies on weak symbols, so is only done when emitting GNU C
+    bool Trans_ShareGenerics_Enabled()
+    {
+        return g_trans_share_generics && Target_GetCurSpec().m_backend_c.m_codegen_mode == CodegenMode::Gnu11;
+    }
+
     struct EnumState
     {
         const ::HIR::Crate& crate;
@@ -33,25 +41,36 @@ namespace {
         ::std::deque<TransList_Function*>  fcn_queue;
         ::std::vector<TransList_Function*> fcns_to_type_visit;
 
-        ::std::set<std::string> emitted_functions;
+        ::std::unordered_set<RcString> emitted_functions;
 
         // Map of locally-defined exported `link_name` functions
         ::std::unordered_map<std::string, std::pair<HIR::SimplePath,const HIR::Function*>>    m_link_functions;
 
+        /// Instances already emitted by upstream crates (see `HIR::Crate::m_shared_instances`)
+        ::std::vector<const ::std::set<::std::string>*> m_upstream_shared;
+
         EnumState(const ::HIR::Crate& crate):
             crate(crate)
             , resolve(crate)
             , orig_list(nullptr)
         {
             enumerate_link_functions();
+            if( Trans_ShareGenerics_Enabled() )
+            {
+                for(const auto& e_crate : crate.m_ext_crates)
+                {
+                    if( !e_crate.second.m_data->m_shared_instances.empty() )
+                        m_upstream_shared.push_back(&e_crate.second.m_data->m_shared_instances);
+                }
+            }
         }
 
         void enum_fcn(::HIR::Path p, const ::HIR::Function& fcn, Trans_Params pp)
         {
             if(auto* e = rv.add_function(mv$(p)))
             {
+                auto name = Trans_Mangle(*e->path);
 #if 1
-                auto name = FMT(Trans_Mangle(*e->path));
                 auto inserted = emitted_functions.insert(name).second;
                 ASSERT_BUG(Span(), inserted, "Duplicated mangled name - " << *e->path);
 #endif
@@ -59,10 +78,31 @@ namespace {
                 e->ptr = &fcn;
                 e->pp = mv$(pp);
                 DEBUG( *e->path << " w/ " << e->pp.pp_impl << " and " << e->pp.pp_method);
+                if( is_upstream_shared(name) )
+                {
+                    // An upstream crate already emitted this instance, just reference it (no need to visit the body)
+                    DEBUG("- Shared by upstream");
+                    e->force_prototype = true;
+                    e->shared_upstream = true;
+                    return ;
+                }
                 fcn_queue.push_back(e);
             }
         }
 
+        bool is_upstream_shared(const RcString& name) const
+        {
+            if( m_upstream_shared.empty() )
+                return false;
+            ::std::string   s = name.c_str();
+            for(const auto* set : m_upstream_shared)
+            {
+                if( set->count(s) )
+                    return true;
+            }
+            return false;
+        }
+
     private:
         void enumerate_link_functions()
         {
@@ -459,6 +499,28 @@ namespace {
     }
 }
 
+void Trans_Enumerate_RecordShared(::HIR::Crate& crate, TransList& list)
+{
+    if( !Trans_ShareGenerics_Enabled() )
+        return ;
+    size_t count = 0;
+    for(const auto& ent : list.m_functions)
+    {
+        const auto& fcn_ent = *ent.second;
+        // Only monomorphised instances, anything else is already emitted once by its defining crate
+        if( !fcn_ent.monomorphised.code || fcn_ent.shared_upstream )
+            continue ;
+        // `#[inline]` functions are left for each crate to instantiate, so they stay available for inlining
+        auto inline_type = fcn_ent.ptr->m_markings.inline_type;
+        if( inline_type == ::HIR::Function::Markings::Inline::Normal || inline_type == ::HIR::Function::Markings::Inline::Always )
+            continue ;
+        crate.m_shared_instances.insert( Trans_Mangle(ent.first).c_str() );
+        list.m_roots.push_back( ent.first.clone() );
+        count ++;
+    }
+    DEBUG("Shared " << count << " instances");
+}
+
 /// Enumerate trans items for all public non-generic items (library crate)
 TransList Trans_Enumerate_Public(::HIR::Crate& crate)
 {
@@ -1068,7 +1130,7 @@ namespace
             DEBUG("Add type " << ty << (shallow ? " (Shallow)": "") << " " << i);
         }
 
-        void __attribute__ ((noinline)) visit_function(const ::HIR::Path& path, const ::HIR::Function& fcn, const Trans_Params& pp)
+        void __attribute__ ((noinline)) visit_function(const ::HIR::Path& path, const ::HIR::Function& fcn, const Trans_Params& pp, bool signature_only)
         {
             Span    sp;
             auto& tv = *this;
@@ -1113,6 +1175,10 @@ namespace
                 tv.visit_type( monomorph(arg.second) );
             }
 
+            // Prototypes (e.g. instances shared by an upstream crate) only need the signature types
+            if( signature_only ) {
+                return ;
+            }
             const MIR::Function* mir_p = nullptr;
             if( fcn.m_code.m_mir ) {
                 mir_p = &*fcn.m_code.m_mir;
@@ -1294,7 +1360,7 @@ void Trans_Enumerate_Types(EnumState& state)
             const auto& pp = p->pp;
 
             TRACE_FUNCTION_F("Function " << fcn_path);
-            tv.visit_function(fcn_path, fcn, pp);
+            tv.visit_function(fcn_path, fcn, pp, p->shared_upstream);
         }
         state.fcns_to_type_visit.clear();
         // TODO: Similarly restrict revisiting of statics.
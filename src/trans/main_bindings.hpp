@@ -19,6 +19,8 @@ struct TransOptions
     unsigned int opt_level = 0;
     bool emit_debug_info = false;
     ::std::string   build_command_file;
+    /// Number of C files (compiled in parallel) to split the generated code across
+    unsigned int codegen_units = 1;
 
     ::std::string   panic_crate;
 
@@ -33,9 +35,15 @@ enum class CodegenOutput {
     Executable, // no suffix, includes main stub (TODO: Can't that just be added earlier?)
 };
 
+/// Share generic instances between crates (cleared by `-C no-share-generics`)
+extern bool g_trans_share_generics;
+
 extern TransList Trans_Enumerate_Main(const ::HIR::Crate& crate);
 // NOTE: This also sets the saveout flags
 extern TransList Trans_Enumerate_Public(::HIR::Crate& crate);
+/// Record the monomorphised instances in `list` that downstream crates can link to (library crates only)
+/// - Populates `HIR::Crate::m_shared_instances`, and adds the instances to the roots so they survive cleanup
+extern void Trans_Enumerate_RecordShared(::HIR::Crate& crate, TransList& list);
 
 /// Re-run enumeration on monomorphised functions, removing now-unused items
 extern void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list);
@@ -43,5 +51,7 @@ extern void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list);
 extern void Trans_AutoImpls(::HIR::Crate& crate, TransList& trans_list);
 
 extern void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list);
+/// Find monomorphised instances that would generate identical code, and flag all but one to be emitted as aliases
+extern void Trans_Monomorphise_MergeInstances(const ::HIR::Crate& crate, TransList& list);
 
 extern void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const TransOptions& opt, const ::HIR::Crate& crate, TransList list, const ::std::string& hir_file);
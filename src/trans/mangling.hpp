@@ -8,6 +8,7 @@
 #pragma once
 #include <string>
 #include <debug.hpp>
+#include <rc_string.hpp>
 
 namespace HIR {
     struct SimplePath;
@@ -16,8 +17,13 @@ namespace HIR {
     class TypeRef;
 }
 
-extern ::FmtLambda Trans_Mangle(const ::HIR::SimplePath& path);
-extern ::FmtLambda Trans_Mangle(const ::HIR::GenericPath& path);
-extern ::FmtLambda Trans_Mangle(const ::HIR::Path& path);
-extern ::FmtLambda Trans_Mangle(const ::HIR::TypeRef& ty);
+/// Emit short hashed symbols (`-C short-symbols`) instead of the full mangled paths
+/// - Must be the same for every crate in a build, as it changes the names of exported symbols
+extern bool g_mangle_short_symbols;
+
+// NOTE: Results are cached, so each path/type is only mangled once
+extern RcString Trans_Mangle(const ::HIR::SimplePath& path);
+extern RcString Trans_Mangle(const ::HIR::GenericPath& path);
+extern RcString Trans_Mangle(const ::HIR::Path& path);
+extern RcString Trans_Mangle(const ::HIR::TypeRef& ty);
 
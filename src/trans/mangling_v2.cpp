@@ -15,6 +15,10 @@
 #include <cctype>
 #include <algorithm>	// std::find
 #include <cmath>	// ceil/log10
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "mangling.hpp"
 
 class Mangler
 {
@@ -372,13 +376,40 @@ public:
     return FMT_CB(os, os << "ZRT"; Mangler(os).fmt_type(p));
 }
 
+bool g_mangle_short_symbols = false;
+
 namespace {
-    ::FmtLambda max_len(::FmtLambda v) {
+    /// Cache of mangled names, so each path/type is only mangled (and formatted) once
+    struct SymbolTable {
+        ::std::mutex    lock;
+        ::std::map<::HIR::SimplePath, RcString>  simple_paths;
+        ::std::map<::HIR::GenericPath, RcString> generic_paths;
+        ::std::map<::HIR::Path, RcString>    paths;
+        ::std::map<::HIR::TypeRef, RcString> types;
+        /// Full name for each short symbol (to detect hash collisions)
+        ::std::unordered_map<uint64_t, ::std::string>    short_symbols;
+    } s_symbols;
+
+    RcString max_len(::FmtLambda v) {
         std::stringstream   ss;
         ss << v;
         auto s = ss.str();
         static const size_t MAX_LEN = 128;
-        if( s.size() > 128 ) {
+        if( g_mangle_short_symbols ) {
+            // FNV-1a (64-bit), as the symbol must be the same for every build (unlike `std::hash`)
+            uint64_t hash = 0xcbf29ce484222325;
+            for(char c : s) {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 0x100000001b3;
+            }
+            auto ins = s_symbols.short_symbols.insert(::std::make_pair(hash, s));
+            ASSERT_BUG(Span(), ins.second || ins.first->second == s, "Short symbol collision between '" << s << "' and '" << ins.first->second << "'");
+            ss.str("");
+            ss << "ZRH" << ::std::hex << hash;
+            DEBUG("Short symbol '" << s << "' -> '" << ss.str() << "'");
+            s = ss.str();
+        }
+        else if( s.size() > 128 ) {
             size_t hash = ::std::hash<std::string>()(s);
             ss.str("");
             ss << s.substr(0, MAX_LEN-9) << "$" << ::std::hex << hash;
@@ -387,16 +418,24 @@ namespace {
         }
         else {
         }
-        return ::FmtLambda([=](::std::ostream& os){
-            os << s;
-            });
+        return RcString(s);
+    }
+
+    template<typename T, typename Fcn>
+    RcString get_cached(::std::map<T, RcString>& cache, const T& v, Fcn mangle) {
+        ::std::lock_guard<::std::mutex> lh { s_symbols.lock };
+        auto it = cache.find(v);
+        if( it == cache.end() ) {
+            it = cache.insert(::std::make_pair(v.clone(), max_len(mangle(v)))).first;
+        }
+        return it->second;
     }
 }
 // TODO: If the mangled name exceeds a limit, stop emitting the real name and start hashing the rest.
-#define DO_MANGLE(ty) ::FmtLambda Trans_Mangle(const ::HIR::ty& v) { \
-    return max_len(Trans_Mangle##ty(v)); \
+#define DO_MANGLE(ty, cache) RcString Trans_Mangle(const ::HIR::ty& v) { \
+    return get_cached(s_symbols.cache, v, Trans_Mangle##ty); \
 }
-DO_MANGLE(SimplePath)
-DO_MANGLE(GenericPath)
-DO_MANGLE(Path)
-DO_MANGLE(TypeRef)
+DO_MANGLE(SimplePath, simple_paths)
+DO_MANGLE(GenericPath, generic_paths)
+DO_MANGLE(Path, paths)
+DO_MANGLE(TypeRef, types)
@@ -11,6 +11,10 @@
 #include <hir/hir.hpp>
 #include <mir/operations.hpp>   // Needed for post-monomorph checks and optimisations
 #include <hir_conv/constant_evaluation.hpp>
+#include <item_profile.hpp>
+#include <parallel.hpp>
+#include <debug_inner.hpp>
+#include "target.hpp"
 
 namespace {
     ::MIR::LValue monomorph_LValue(const ::StaticTraitResolve& resolve, const Trans_Params& params, const ::MIR::LValue& tpl)
@@ -162,7 +166,8 @@ namespace {
     for(const auto& var : tpl->locals)
     {
         DEBUG("- _" << output.locals.size() << " (" << var << ")");
-        output.locals.push_back( params.monomorph(resolve, var) );
+        // Interned, so later lookups keyed on these types (e.g. type reprs) are pointer comparisons
+        output.locals.push_back( params.monomorph(resolve, var).intern() );
         DEBUG(" = " << output.locals.back());
     }
     output.drop_flags = tpl->drop_flags;
@@ -484,18 +489,27 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
         }
     }
 
+    // Functions are independent of each other, so are processed in parallel (if enabled)
+    // - Each thread uses its own resolver, and results are only written to the function's own entry
+    ::std::vector<::std::pair<const ::HIR::Path, ::std::unique_ptr<TransList_Function>>*>   fcn_ents;
+    fcn_ents.reserve(list.m_functions.size());
     for(auto& fcn_ent : list.m_functions)
+        fcn_ents.push_back(&fcn_ent);
+    Parallel_ForEach(fcn_ents.size(), [&](){ return ::StaticTraitResolve { crate }; }, [&](::StaticTraitResolve& resolve, size_t i)
     {
+        auto& fcn_ent = *fcn_ents[i];
         const auto& fcn = *fcn_ent.second->ptr;
         // Trait methods (which are the only case where `Self` can exist in the argument list at this stage) always need to be monomorphised.
         bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef::new_self();}) );
-        bool monomorph_needed = fcn_ent.second->pp.has_types() || is_method;
+        // Instances shared by an upstream crate are only referenced, so have no code to emit
+        bool monomorph_needed = (fcn_ent.second->pp.has_types() || is_method) && !fcn_ent.second->shared_upstream;
 
         if( monomorph_needed )
         {
             const auto& path = fcn_ent.first;
             const auto& pp = fcn_ent.second->pp;
             TRACE_FUNCTION_FR("FUNCTION " << path, "FUNCTION " << path);
+            ItemProfileScope    profile("Trans Monomorphise", path);
             ASSERT_BUG(Span(), fcn.m_code.m_mir, "No code for " << path);
 
             // TODO: Get the item params too
@@ -507,10 +521,10 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
             auto mir = Trans_Monomorphise(resolve, fcn_ent.second->pp, fcn.m_code.m_mir);
 
             // TODO: Should these be moved to their own pass? Potentially not, the extra pass should just be an inlining optimise pass
-            auto ret_type = pp.monomorph(resolve, fcn.m_return);
+            auto ret_type = pp.monomorph(resolve, fcn.m_return).intern();
             ::HIR::Function::args_t args;
             for(const auto& a : fcn.m_args)
-                args.push_back(::std::make_pair( ::HIR::Pattern{}, pp.monomorph(resolve, a.second) ));
+                args.push_back(::std::make_pair( ::HIR::Pattern{}, pp.monomorph(resolve, a.second).intern() ));
 
             //::std::string s = FMT(path);
             ::HIR::ItemPath ip(path);
@@ -528,6 +542,122 @@ void Trans_Monomorphise_List(const ::HIR::Crate& crate, TransList& list)
         {
             DEBUG("Non-generic: FUNCTION " << fcn_ent.first);
         }
+    });
+}
+
+namespace {
+    DebugPhaseCounter   s_counter_instances_merged("instances_merged");
+    DebugPhaseCounter   s_counter_merged_c_lines("instances_merged_c_lines");
+
+    /// Check if two (monomorphised) types generate the same code
+    /// - Zero-sized types without drop glue have no runtime representation (e.g. capture-less closures, `PhantomData<T>`)
+    bool types_codegen_equal(const ::StaticTraitResolve& resolve, const ::HIR::TypeRef& a, const ::HIR::TypeRef& b)
+    {
+        static Span sp;
+        if( a == b )
+            return true;
+        for(const auto* ty : { &a, &b })
+        {
+            size_t size, align;
+            if( !Target_GetSizeAndAlignOf(sp, resolve, *ty, size, align) || size != 0 )
+                return false;
+            if( resolve.type_needs_drop_glue(sp, *ty) )
+                return false;
+        }
+        return true;
+    }
+    bool instances_codegen_equal(const ::StaticTraitResolve& resolve, const CachedFunction& a, const CachedFunction& b)
+    {
+        // NOTE: `()` and `!` are returned as `void`, so can't be swapped with other zero-sized return types
+        for(const auto* ty : { &a.ret_ty, &b.ret_ty })
+        {
+            if( a.ret_ty != b.ret_ty && (*ty == ::HIR::TypeRef::new_unit() || ty->data().is_Diverge()) )
+                return false;
+        }
+        if( !types_codegen_equal(resolve, a.ret_ty, b.ret_ty) )
+            return false;
+        assert(a.arg_tys.size() == b.arg_tys.size());
+        for(size_t i = 0; i < a.arg_tys.size(); i ++)
+        {
+            if( !types_codegen_equal(resolve, a.arg_tys[i].second, b.arg_tys[i].second) )
+                return false;
+        }
+
+        const auto& fa = *a.code;
+        const auto& fb = *b.code;
+        if( fa.drop_flags != fb.drop_flags )
+            return false;
+        for(size_t i = 0; i < fa.locals.size(); i ++)
+        {
+            if( !types_codegen_equal(resolve, fa.locals[i], fb.locals[i]) )
+                return false;
+        }
+        // Statements and terminators are compared exactly, as any types/paths within them (casts, calls, constructors)
+        // change the generated code.
+        for(size_t i = 0; i < fa.blocks.size(); i ++)
+        {
+            const auto& ba = fa.blocks[i];
+            const auto& bb = fb.blocks[i];
+            if( ba.statements.size() != bb.statements.size() )
+                return false;
+            for(size_t j = 0; j < ba.statements.size(); j ++)
+            {
+                if( !(ba.statements[j] == bb.statements[j]) )
+                    return false;
+            }
+            if( !(ba.terminator == bb.terminator) )
+                return false;
+        }
+        return true;
+    }
+    /// Rough count of the lines the C backend emits for a function (header, locals, and two per statement)
+    size_t estimate_c_lines(const CachedFunction& f)
+    {
+        size_t rv = 4 + f.arg_tys.size() + f.code->locals.size() + f.code->drop_flags.size();
+        for(const auto& bb : f.code->blocks)
+            rv += 3 + 2 * bb.statements.size();
+        return rv;
     }
 }
 
+void Trans_Monomorphise_MergeInstances(const ::HIR::Crate& crate, TransList& list)
+{
+    // Merged instances are emitted using `__attribute__((alias))`, which needs GNU C and isn't supported by Mach-O
+    if( Target_GetCurSpec().m_backend_c.m_codegen_mode != CodegenMode::Gnu11 || Target_GetCurSpec().m_os_name == "macos" )
+        return ;
+    ::StaticTraitResolve    resolve { crate };
+
+    // Bucket by source function and MIR shape, only instances within a bucket can match
+    typedef ::std::tuple<const ::HIR::Function*, size_t, size_t, size_t>  key_t;
+    ::std::map<key_t, ::std::vector<TransList_Function*>>  buckets;
+    for(auto& ent : list.m_functions)
+    {
+        auto& fcn_ent = *ent.second;
+        if( fcn_ent.force_prototype || !fcn_ent.monomorphised.code )
+            continue ;
+        // Functions with an explicit symbol name must keep their own body
+        if( fcn_ent.ptr->m_linkage.name != "" )
+            continue ;
+        const auto& code = *fcn_ent.monomorphised.code;
+        size_t n_stmts = 0;
+        for(const auto& bb : code.blocks)
+            n_stmts += bb.statements.size();
+        auto& bucket = buckets[key_t(fcn_ent.ptr, code.locals.size(), code.blocks.size(), n_stmts)];
+
+        for(const auto* other : bucket)
+        {
+            if( instances_codegen_equal(resolve, other->monomorphised, fcn_ent.monomorphised) )
+            {
+                DEBUG(ent.first << " = " << *other->path);
+                fcn_ent.alias_of = other->path;
+                s_counter_instances_merged.inc();
+                s_counter_merged_c_lines.add(estimate_c_lines(fcn_ent.monomorphised));
+                break;
+            }
+        }
+        if( !fcn_ent.alias_of )
+        {
+            bucket.push_back(&fcn_ent);
+        }
+    }
+}
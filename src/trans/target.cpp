@@ -10,6 +10,7 @@
 #include "../expand/cfg.hpp"
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <hir/hir.hpp>
 #include <hir_typeck/helpers.hpp>
 #include <hir_conv/main_bindings.hpp>   // ConvertHIR_ConstantEvaluate_Enum
@@ -2162,12 +2163,14 @@ namespace {
         return rv;
     }
 
-    // TODO: Thread safety on this cache?
     static ::std::map<::HIR::TypeRef, ::std::unique_ptr<TypeRepr>>  s_cache;
+    // Recursive, as computing a repr looks up (and can set) the reprs of inner types
+    static ::std::recursive_mutex   s_cache_lock;
 
     void set_type_repr(const Span& sp, const ::HIR::TypeRef& ty, ::std::unique_ptr<TypeRepr> repr)
     {
-        auto ires = s_cache.insert(::std::make_pair( ty.clone(), mv$(repr) ));
+        ::std::lock_guard<::std::recursive_mutex>   lh { s_cache_lock };
+        auto ires = s_cache.insert(::std::make_pair( ty.intern(), mv$(repr) ));
         ASSERT_BUG(sp, ires.second, "set_type_repr called for type that already has a repr: " << ty);
         DEBUG("Set repr for " << ires.first->first);
     }
@@ -2189,13 +2192,14 @@ const TypeRepr* Target_GetTypeRepr(const Span& sp, const StaticTraitResolve& res
         return Target_GetTypeRepr(sp, resolve, ::HIR::TypeRef::new_path( mv$(path), ::HIR::TypePathBinding::make_Struct(&str) ));
     }
 #endif
+    ::std::lock_guard<::std::recursive_mutex>   lh { s_cache_lock };
     auto it = s_cache.find(ty);
     if( it != s_cache.end() )
     {
         return it->second.get();
     }
 
-    auto ires = s_cache.insert(::std::make_pair( ty.clone(), make_type_repr(sp, resolve, ty) ));
+    auto ires = s_cache.insert(::std::make_pair( ty.intern(), make_type_repr(sp, resolve, ty) ));
     if(ires.second)
     {
         DEBUG("Created repr for " << ires.first->first);
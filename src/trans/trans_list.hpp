@@ -87,11 +87,18 @@ struct TransList_Function
     CachedFunction  monomorphised;
     /// Forces the function to not be emited as code (just emit the signature)
     bool    force_prototype;
+    /// This instance is emitted (and shared) by an upstream crate, only its signature is needed
+    /// - `force_prototype` is also set, this additionally skips monomorphisation/inlining of the body
+    bool    shared_upstream;
+    /// Another instance with identical generated code, this instance is emitted as an alias of it
+    const ::HIR::Path*  alias_of;
 
     TransList_Function(const ::HIR::Path& path):
         path(&path),
         ptr(nullptr),
-        force_prototype(false)
+        force_prototype(false),
+        shared_upstream(false),
+        alias_of(nullptr)
     {}
 };
 struct TransList_Static
@@ -21,6 +21,8 @@
 #include <cassert>
 
 #include <cstdint>
+#include <cstdio>   // rename/remove/snprintf
+#include <cstring>
 #include <unordered_map>
 #include <algorithm>    // sort/find_if
 
@@ -39,12 +41,23 @@ struct RunState
     BuildOptions&   m_opts;
     const helpers::path& m_compiler_path;
     bool m_is_cross_compiling;
+    /// Shared artifact cache (from `MINICARGO_CACHE_DIR`), outputs are stored under the hash of their inputs
+    helpers::path   m_cache_dir;
+
+    /// Content hashes of files read so far, invalidated if the timestamp changes
+    mutable ::std::unordered_map<::std::string, ::std::pair<Timestamp, ::std::string>>  m_file_hashes;
 
     RunState(BuildOptions& opts, bool is_cross_compiling)
         : m_opts(opts)
         , m_compiler_path(os_support::get_mrustc_path())
         , m_is_cross_compiling(is_cross_compiling)
-    {}
+    {
+        if( const char* cache_dir = getenv("MINICARGO_CACHE_DIR") ) {
+            if( cache_dir[0] ) {
+                m_cache_dir = cache_dir;
+            }
+        }
+    }
 
     bool is_rustc() const {
         return m_compiler_path.basename() == "rustc" || m_compiler_path.basename() == "rustc.exe";
@@ -86,6 +99,17 @@ struct RunState
 
     bool outfile_needs_rebuild(const helpers::path& outfile) const;
 
+    /// Hash of a file's contents (empty if the file can't be read)
+    const ::std::string& get_file_hash(const helpers::path& path) const;
+    /// Hash of the command line, environment, and compiler used for a job
+    ::std::string get_command_hash(const RunnableJob& rjob) const;
+    /// Hash of the command and the contents of every input listed in `depfile` (empty if the inputs aren't known)
+    ::std::string get_input_hash(const ::std::string& command_hash, const helpers::path& depfile, const helpers::path& outfile) const;
+    /// Copy the cached outputs for `input_hash` into place, returns false if the cache doesn't have them
+    bool restore_from_cache(const ::std::string& input_hash, const helpers::path& outfile) const;
+    /// Store a successful build's outputs (and its depfile, used to find them again) in the cache
+    void store_to_cache(const ::std::string& command_hash, const ::std::string& input_hash, const helpers::path& outfile) const;
+
     /// Get the crate suffix (stuff added to the crate name to form the filename)
     ::std::string get_crate_suffix(const PackageManifest& manifest) const;
     /// Get the base of all build script names (relative to output dir)
@@ -112,6 +136,8 @@ protected:
     const PackageManifest&  m_manifest;
 
     ::std::string   m_name;
+    /// Hash of the command used for the current run (populated by `is_up_to_date`)
+    ::std::string   m_command_hash;
 public:
     bool m_is_dirty;
     ::std::vector<std::string>  m_dependencies;
@@ -140,6 +166,7 @@ public:
     bool is_runnable() const override {
         return true;
     }
+    bool is_up_to_date(const RunnableJob& rjob) override;
     bool complete(bool was_success) override;
     virtual helpers::path get_outfile() const = 0;
 };
@@ -159,6 +186,13 @@ public:
 
     RunnableJob start() override;
     helpers::path get_outfile() const override;
+    helpers::path metadata_marker() const override;
+    bool can_use_dependency_metadata() const override {
+        return is_pipelined();
+    }
+private:
+    /// Plain rust libraries only need their dependencies' metadata, and can signal when their own is ready
+    bool is_pipelined() const;
 };
 class Job_BuildScript: public Job_Build
 {
@@ -327,6 +361,10 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs, bool dry_run)
 
     RunState    run_state { opts, cross_compiling };
     JobList runner;
+    if( !dry_run )
+    {
+        runner.set_history_file(opts.output_dir / "minicargo-durations.txt");
+    }
 
     struct ConvertState {
         JobList& joblist;
@@ -538,6 +576,65 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs, bool dry_run)
 }
 
 namespace {
+    /// Non-cryptographic 128-bit hash (two independent 64-bit lanes), used to identify build inputs
+    class InputHasher
+    {
+        uint64_t    m_a = 0xcbf29ce484222325ull;
+        uint64_t    m_b = 0x6a09e667f3bcc909ull;
+    public:
+        void feed(const void* data, size_t len) {
+            const auto* p = static_cast<const uint8_t*>(data);
+            for(size_t i = 0; i < len; i ++)
+            {
+                m_a = (m_a ^ p[i]) * 0x100000001b3ull;
+                m_b = (m_b + p[i] + 1) * 0x9e3779b97f4a7c15ull;
+                m_b ^= m_b >> 29;
+            }
+        }
+        /// Add a length-prefixed string (so adjacent strings can't run together)
+        void feed_str(const char* s) {
+            uint64_t len = strlen(s);
+            feed(&len, sizeof(len));
+            feed(s, len);
+        }
+        void feed_str(const ::std::string& s) {
+            feed_str(s.c_str());
+        }
+        bool feed_file(const helpers::path& path) {
+            ::std::ifstream ifs(path.str(), ::std::ios::binary);
+            if( !ifs.good() )
+                return false;
+            char    buf[64*1024];
+            while( ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0 )
+            {
+                feed(buf, static_cast<size_t>(ifs.gcount()));
+            }
+            return true;
+        }
+        ::std::string hex() const {
+            char    buf[33];
+            snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(m_a), static_cast<unsigned long long>(m_b));
+            return buf;
+        }
+    };
+
+    /// Copy a file, via a temporary so a concurrent reader never sees a partial file
+    bool copy_file(const helpers::path& src, const helpers::path& dst)
+    {
+        auto tmp = dst + ".tmp";
+        {
+            ::std::ifstream ifs(src.str(), ::std::ios::binary);
+            if( !ifs.good() )
+                return false;
+            ::std::ofstream ofs(tmp.str(), ::std::ios::binary);
+            ofs << ifs.rdbuf();
+            if( !ofs.good() )
+                return false;
+        }
+        remove(dst.str().c_str());
+        return rename(tmp.str().c_str(), dst.str().c_str()) == 0;
+    }
+
     ::std::map< ::std::string, ::std::vector<helpers::path> > load_depfile(const helpers::path& depfile_path)
     {
         ::std::map< ::std::string, ::std::vector<helpers::path> >   rv;
@@ -735,6 +832,106 @@ bool RunState::outfile_needs_rebuild(const helpers::path& outfile) const
     }
 }
 
+const ::std::string& RunState::get_file_hash(const helpers::path& path) const
+{
+    static const ::std::string  s_missing;
+    auto ts = Timestamp::for_file(path);
+    if( ts == Timestamp::infinite_past() )
+        return s_missing;
+    auto it = m_file_hashes.find(path.str());
+    if( it != m_file_hashes.end() && it->second.first == ts )
+        return it->second.second;
+
+    InputHasher h;
+    if( !h.feed_file(path) )
+        return s_missing;
+    if( it != m_file_hashes.end() ) {
+        it->second = ::std::make_pair(ts, h.hex());
+    }
+    else {
+        it = m_file_hashes.insert(::std::make_pair(path.str(), ::std::make_pair(ts, h.hex()))).first;
+    }
+    return it->second.second;
+}
+::std::string RunState::get_command_hash(const RunnableJob& rjob) const
+{
+    InputHasher h;
+    h.feed_str(rjob.exe_name);
+    // Unless tools are being ignored (see `outfile_needs_rebuild`), a different compiler invalidates everything
+    if( !getenv("MINICARGO_IGNTOOLS") ) {
+        h.feed_str(get_file_hash(m_compiler_path));
+    }
+    for(const auto& a : rjob.args.get_vec()) {
+        h.feed_str(a);
+    }
+    for(const auto& e : rjob.env) {
+        h.feed_str(e.first);
+        h.feed_str(e.second);
+    }
+    return h.hex();
+}
+::std::string RunState::get_input_hash(const ::std::string& command_hash, const helpers::path& depfile, const helpers::path& outfile) const
+{
+    auto depfile_ents = load_depfile(depfile);
+    auto it = depfile_ents.find(outfile);
+    if( it == depfile_ents.end() )
+        return "";
+    InputHasher h;
+    h.feed_str(command_hash);
+    for(const auto& f : it->second)
+    {
+        const auto& fh = get_file_hash(f);
+        if( fh == "" ) {
+            DEBUG("Can't hash inputs for " << outfile << " - " << f << " is missing");
+            return "";
+        }
+        h.feed_str(f.str());
+        h.feed_str(fh);
+    }
+    return h.hex();
+}
+// Cache layout:
+// - `<command_hash>.d`: The depfile from the most recent build of a command, used to get the input list before building
+// - `<input_hash>/<name>[.hir|.d]`: The outputs of a build with the given inputs
+// The main output is written last, so its presence indicates a complete entry.
+bool RunState::restore_from_cache(const ::std::string& input_hash, const helpers::path& outfile) const
+{
+    auto entry_dir = m_cache_dir / input_hash.c_str();
+    auto name = outfile.basename();
+    if( Timestamp::for_file(entry_dir / name.c_str()) == Timestamp::infinite_past() )
+        return false;
+    for(const char* suf : { ".hir", ".d" })
+    {
+        auto src = (entry_dir / name.c_str()) + suf;
+        if( !(Timestamp::for_file(src) == Timestamp::infinite_past()) ) {
+            if( !copy_file(src, outfile + suf) )
+                return false;
+        }
+    }
+    return copy_file(entry_dir / name.c_str(), outfile);
+}
+void RunState::store_to_cache(const ::std::string& command_hash, const ::std::string& input_hash, const helpers::path& outfile) const
+{
+    auto entry_dir = m_cache_dir / input_hash.c_str();
+    auto name = outfile.basename();
+    try {
+        os_support::mkdir(m_cache_dir);
+        os_support::mkdir(entry_dir);
+    }
+    catch(const ::std::exception& e) {
+        ::std::cerr << "WARNING: Unable to create cache directory " << entry_dir << ": " << e.what() << ::std::endl;
+        return ;
+    }
+    for(const char* suf : { ".hir", ".d" })
+    {
+        if( !(Timestamp::for_file(outfile + suf) == Timestamp::infinite_past()) ) {
+            copy_file(outfile + suf, (entry_dir / name.c_str()) + suf);
+        }
+    }
+    copy_file(outfile, entry_dir / name.c_str());
+    copy_file(outfile + ".d", m_cache_dir / (command_hash + ".d"));
+}
+
 ::std::string RunState::get_build_script_out(const PackageManifest& manifest) const
 {
     return std::string("build_") + manifest.name().c_str() + (manifest.version() == PackageVersion() ? "" : get_crate_suffix(manifest).c_str());
@@ -801,11 +998,52 @@ bool RunState::outfile_needs_rebuild(const helpers::path& outfile) const
 }
 
 
+bool Job_Build::is_up_to_date(const RunnableJob& rjob)
+{
+    auto outfile = get_outfile();
+    m_command_hash = parent.get_command_hash(rjob);
+
+    // If the inputs (as listed by the previous build's depfile) hash to the same value as that build, the output is still valid
+    auto input_hash = parent.get_input_hash(m_command_hash, outfile + ".d", outfile);
+    if( input_hash != "" && !(Timestamp::for_file(outfile) == Timestamp::infinite_past()) )
+    {
+        ::std::ifstream ifs(outfile + ".hash");
+        ::std::string   prev_hash;
+        if( ifs >> prev_hash && prev_hash == input_hash ) {
+            DEBUG("Not building " << outfile << " - inputs unchanged (" << input_hash << ")");
+            return true;
+        }
+    }
+
+    // Check the shared cache, using the depfile of the last cached build of this command to find the inputs
+    if( parent.m_cache_dir.is_valid() )
+    {
+        auto cached_hash = parent.get_input_hash(m_command_hash, parent.m_cache_dir / (m_command_hash + ".d"), outfile);
+        if( cached_hash != "" && parent.restore_from_cache(cached_hash, outfile) ) {
+            DEBUG("Not building " << outfile << " - restored from cache (" << cached_hash << ")");
+            ::std::ofstream(outfile + ".hash") << cached_hash << "\n";
+            return true;
+        }
+    }
+    return false;
+}
 bool Job_Build::complete(bool was_success)
 {
+    auto outfile = get_outfile();
     if(!was_success) {
         // On failure, remove the output (to force a rebuild next time)
-        remove(get_outfile().str().c_str());
+        remove(outfile.str().c_str());
+        remove((outfile + ".hash").str().c_str());
+    }
+    else if( m_command_hash != "" ) {
+        // Record the hash of the inputs (now listed in the new depfile), so an unchanged rebuild can be skipped
+        auto input_hash = parent.get_input_hash(m_command_hash, outfile + ".d", outfile);
+        if( input_hash != "" ) {
+            ::std::ofstream(outfile + ".hash") << input_hash << "\n";
+            if( parent.m_cache_dir.is_valid() ) {
+                parent.store_to_cache(m_command_hash, input_hash, outfile);
+            }
+        }
     }
     return true;
 }
@@ -872,6 +1110,20 @@ helpers::path Job_BuildTarget::get_outfile() const
 {
     return parent.get_crate_path(m_manifest, m_target, m_is_for_host, nullptr, nullptr);
 }
+bool Job_BuildTarget::is_pipelined() const
+{
+    if( parent.is_rustc() )
+        return false;
+    const char* crate_type = "";
+    parent.get_crate_path(m_manifest, m_target, m_is_for_host, &crate_type, nullptr);
+    return strcmp(crate_type, "rlib") == 0;
+}
+helpers::path Job_BuildTarget::metadata_marker() const
+{
+    if( !is_pipelined() )
+        return helpers::path();
+    return get_outfile() + ".meta";
+}
 RunnableJob Job_BuildTarget::start()
 {
     const char* crate_type;
@@ -882,6 +1134,9 @@ RunnableJob Job_BuildTarget::start()
     StringList  args;
     args.push_back(m_manifest.directory() / ::helpers::path(m_target.m_path));
     push_args_common(args, outfile, m_is_for_host);
+    if( is_pipelined() ) {
+        args.push_back("-C"); args.push_back(format("emit-metadata-marker=",metadata_marker()));
+    }
     args.push_back("--crate-name"); args.push_back(m_target.m_name.c_str());
     args.push_back("--crate-type"); args.push_back(crate_type);
     if( !crate_suffix.empty() ) {
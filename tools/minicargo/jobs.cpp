@@ -17,9 +17,12 @@
 #include "jobserver.h"
 #include "os.hpp"
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 
 #include <cassert>
 #include <algorithm>
+#include <thread>   // this_thread::sleep_for
 
 #ifdef _WIN32
 # include <Windows.h>
@@ -34,6 +37,167 @@ void JobList::add_job(::std::unique_ptr<Job> job)
     waiting_jobs.push_back(std::move(job));
 }
 
+void JobList::set_history_file(::helpers::path path)
+{
+    m_history_file = ::std::move(path);
+    m_durations.clear();
+
+    // Format: `<seconds> <job name>` per line
+    ::std::ifstream ifs(m_history_file.str());
+    ::std::string   line;
+    while( ::std::getline(ifs, line) )
+    {
+        ::std::istringstream    ss(line);
+        double  secs;
+        if( !(ss >> secs) )
+            continue;
+        ss.get();   // Skip the separating space
+        ::std::string   name;
+        ::std::getline(ss, name);
+        if( name.empty() )
+            continue;
+        m_durations[name] = secs;
+    }
+    DEBUG("Loaded " << m_durations.size() << " job durations from " << m_history_file);
+}
+void JobList::save_history() const
+{
+    if( !m_history_file.is_valid() )
+        return;
+    // Sorted for a stable file
+    ::std::vector<const ::std::pair<const std::string, double>*>    ents;
+    for(const auto& e : m_durations)
+        ents.push_back(&e);
+    ::std::sort(ents.begin(), ents.end(), [](const auto* a, const auto* b){ return a->first < b->first; });
+
+    ::std::ofstream ofs(m_history_file.str());
+    for(const auto* e : ents)
+        ofs << e->second << " " << e->first << "\n";
+}
+
+// Prioritise jobs by the (historical) duration of the longest chain of jobs that starts at them (the critical path),
+// so the long poles of a build are started as early as possible.
+void JobList::calculate_priorities()
+{
+    // Jobs without a recorded duration are assumed to take the average time
+    double  default_cost = 1.0;
+    if( !m_durations.empty() )
+    {
+        double  total = 0;
+        for(const auto& e : m_durations)
+            total += e.second;
+        default_cost = total / m_durations.size();
+    }
+
+    ::std::unordered_map<std::string, const Job*>  jobs;
+    ::std::unordered_map<std::string, std::vector<const Job*>>   dependents;
+    for(const auto& j : this->waiting_jobs)
+    {
+        jobs[j->name()] = j.get();
+        for(const auto& d : j->dependencies())
+            dependents[d].push_back(j.get());
+    }
+
+    m_priorities.clear();
+    struct H {
+        JobList& self;
+        const ::std::unordered_map<std::string, std::vector<const Job*>>&   dependents;
+        double  default_cost;
+
+        double get(const Job& j) {
+            auto it = self.m_priorities.find(j.name());
+            if( it != self.m_priorities.end() )
+                return it->second;
+            auto d_it = self.m_durations.find(j.name());
+            double  cost = (d_it != self.m_durations.end() ? d_it->second : default_cost);
+            double  tail = 0;
+            auto deps_it = dependents.find(j.name());
+            if( deps_it != dependents.end() )
+            {
+                for(const auto* dj : deps_it->second)
+                    tail = ::std::max(tail, this->get(*dj));
+            }
+            return self.m_priorities[j.name()] = cost + tail;
+        }
+    } h { *this, dependents, default_cost };
+    for(const auto& e : jobs)
+        h.get(*e.second);
+}
+
+bool JobList::dependencies_ready(const Job& job) const
+{
+    const auto& deps = job.dependencies();
+    return std::all_of(deps.begin(), deps.end(), [&](const std::string& s){
+        return completed_jobs.count(s) > 0 || (job.can_use_dependency_metadata() && metadata_ready_jobs.count(s) > 0);
+        });
+}
+void JobList::mark_complete(const std::string& name, const std::vector<std::string>& dependencies)
+{
+    this->finished_jobs.push_back(::std::make_pair(name, dependencies));
+    // Completing a job may allow an earlier-finished job to complete, so keep going until nothing changes
+    bool changed;
+    do {
+        changed = false;
+        for(auto it = this->finished_jobs.begin(); it != this->finished_jobs.end(); )
+        {
+            const auto& deps = it->second;
+            if( std::all_of(deps.begin(), deps.end(), [&](const std::string& s){ return completed_jobs.count(s) > 0; }) )
+            {
+                this->completed_jobs.insert(it->first);
+                it = this->finished_jobs.erase(it);
+                changed = true;
+            }
+            else
+            {
+                ++ it;
+            }
+        }
+    } while(changed);
+}
+bool JobList::poll_metadata()
+{
+    bool rv = false;
+    for(auto& rj : this->running_jobs)
+    {
+        if( rj.metadata_ready )
+            continue;
+        auto marker = rj.job->metadata_marker();
+        if( marker.is_valid() && ::std::ifstream(marker.str()).good() )
+        {
+            DEBUG("Metadata ready for " << rj.job->name());
+            rj.metadata_ready = true;
+            this->metadata_ready_jobs.insert(rj.job->name());
+            rv = true;
+        }
+    }
+    return rv;
+}
+bool JobList::wait_for_progress()
+{
+    for(;;)
+    {
+        // If nothing running can signal early, just block until a job finishes
+        bool any_pending_metadata = ::std::any_of(this->running_jobs.begin(), this->running_jobs.end(), [](const RunningJob& rj) {
+            return !rj.metadata_ready && rj.job->metadata_marker().is_valid();
+            });
+        if( !any_pending_metadata ) {
+            return wait_one();
+        }
+
+        auto n_running = this->running_jobs.size();
+        if( !wait_one(false) ) {
+            return false;
+        }
+        if( this->running_jobs.size() != n_running ) {
+            return true;
+        }
+        if( this->poll_metadata() ) {
+            return true;
+        }
+        ::std::this_thread::sleep_for(::std::chrono::milliseconds(50));
+    }
+}
+
 bool JobList::run_all(size_t num_jobs, bool dry_run)
 {
     // Sort jobs by name, to provide a consistent execution order
@@ -116,6 +280,7 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         this->waiting_jobs.erase(new_end, this->waiting_jobs.end());
     }
     #endif
+    this->calculate_priorities();
 
     while( !this->waiting_jobs.empty() || !this->runnable_jobs.empty() || !this->running_jobs.empty() )
     {
@@ -128,7 +293,7 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
             //   - We're being limited by our own internal limits (either via `-j` or because there's no jobserver)
             while( this->running_jobs.size() > 0 && (force_wait || (num_jobs > 0 && this->running_jobs.size() >= num_jobs)) )
             {
-                if( !wait_one() ) {
+                if( !wait_for_progress() ) {
                     dump_state();
                     failed = true;
                     break;
@@ -153,8 +318,7 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         for(auto& slot : this->waiting_jobs)
         {
             assert(slot);
-            const auto& deps = slot->dependencies();
-            if( std::all_of(deps.begin(), deps.end(), [&](const std::string& s){ return completed_jobs.count(s) > 0; }) && slot->is_runnable() )
+            if( this->dependencies_ready(*slot) && slot->is_runnable() )
             {
                 this->runnable_jobs.push_back(std::move(slot));
             }
@@ -162,7 +326,12 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         auto new_end = std::remove_if(waiting_jobs.begin(), waiting_jobs.end(), [](const job_t& j){ return !j; });
         waiting_jobs.erase(new_end, waiting_jobs.end());
 
-        ::std::sort(runnable_jobs.begin(), runnable_jobs.end(), [](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+        // Longest remaining chain first (ties broken by name, for a consistent order)
+        ::std::sort(runnable_jobs.begin(), runnable_jobs.end(), [&](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+            auto pa = m_priorities[a->name()];
+            auto pb = m_priorities[b->name()];
+            if( pa != pb )
+                return pa > pb;
             return a->name() < b->name();
         });
 
@@ -216,6 +385,17 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
             ::std::cout << ::std::endl;
             continue;
         }
+        if( job->is_up_to_date(rjob) )
+        {
+            ::std::cout << "--- ";
+            os_support::set_console_colour(::std::cout, os_support::TerminalColour::Green);
+            ::std::cout << "FRESH " << job->name();
+            os_support::set_console_colour(::std::cout, os_support::TerminalColour::Default);
+            ::std::cout << ::std::endl;
+            this->metadata_ready_jobs.insert(job->name());
+            this->mark_complete(job->name(), job->dependencies());
+            continue;
+        }
         {
             ::std::cout << "--- ";
             os_support::set_console_colour(::std::cout, os_support::TerminalColour::Green);
@@ -230,8 +410,13 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
             ::std::cout << std::endl;
         }
 
+        // Remove any stale metadata marker, so dependents don't start early
+        auto marker = job->metadata_marker();
+        if( marker.is_valid() ) {
+            remove(marker.str().c_str());
+        }
         auto handle = this->spawn(rjob);
-        this->running_jobs.push_back(RunningJob { handle, std::move(job), std::move(rjob) });
+        this->running_jobs.push_back(RunningJob { handle, std::move(job), std::move(rjob), ::std::chrono::steady_clock::now(), false });
         dump_state();
     }
     while( !this->running_jobs.empty() )
@@ -246,6 +431,9 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
             jobserver->return_one();
         }
     }
+    if( !dry_run ) {
+        this->save_history();
+    }
     return !failed;
 }
 
@@ -330,7 +518,12 @@ bool JobList::wait_one(bool block)
     else
     {
         ::std::cout << "Completed " << rjob.job->name() << std::endl;
-        this->completed_jobs.insert(rjob.job->name());
+        if( rjob.job->metadata_marker().is_valid() ) {
+            this->metadata_ready_jobs.insert(rjob.job->name());
+        }
+        this->mark_complete(rjob.job->name(), rjob.job->dependencies());
+        ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - rjob.start_time;
+        m_durations[rjob.job->name()] = elapsed.count();
     }
     rv &= rjob.job->complete(rv);
     if(getenv("MINICARGO_RUN_ONCE") || getenv("MINICARGO_RUNONCE"))
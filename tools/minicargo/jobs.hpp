@@ -5,6 +5,8 @@
 #include <memory>
 #include <vector>
 #include <deque>
+#include <chrono>
+#include <unordered_map>
 #include <unordered_set>
 #include "stringlist.h"
 #include <path.h>
@@ -42,6 +44,12 @@ public:
     virtual const std::vector<std::string>& dependencies() const = 0;
     virtual bool is_runnable() const = 0;
     virtual RunnableJob start() = 0;
+    /// Called with the result of `start`, returns true if the outputs are already valid for that command (so it doesn't need to run)
+    virtual bool is_up_to_date(const RunnableJob& rjob) { return false; }
+    /// File created by the job once its metadata is written (before it completes), invalid if it doesn't signal this
+    virtual ::helpers::path metadata_marker() const { return ::helpers::path(); }
+    /// Returns true if the job can start once its dependencies' metadata is ready (instead of waiting for them to complete)
+    virtual bool can_use_dependency_metadata() const { return false; }
     virtual bool complete(bool was_successful) = 0;
 };
 class JobList
@@ -51,6 +59,8 @@ class JobList
         os_support::Process handle;
         job_t   job;
         RunnableJob desc;
+        ::std::chrono::steady_clock::time_point start_time;
+        bool    metadata_ready;
         RunningJob(RunningJob&& ) = default;
         RunningJob& operator=(RunningJob&& ) = default;
     };
@@ -59,12 +69,33 @@ class JobList
     ::std::deque<job_t>    runnable_jobs;
     ::std::vector<RunningJob>   running_jobs;
     ::std::unordered_set<std::string>  completed_jobs;
+    /// Jobs (running or complete) whose metadata has been written
+    ::std::unordered_set<std::string>  metadata_ready_jobs;
+    /// Jobs that have finished, but started before all of their dependencies completed
+    /// - Not marked as complete until those have, so jobs needing the full outputs (e.g. for linking) wait for everything
+    ::std::vector<::std::pair<std::string, std::vector<std::string>>>    finished_jobs;
+
+    /// File storing the duration (in seconds) of previous runs of each job
+    ::helpers::path m_history_file;
+    ::std::unordered_map<std::string, double>   m_durations;
+    /// Scheduling priority: the expected time from starting a job to the end of the longest chain of jobs that need it
+    ::std::unordered_map<std::string, double>   m_priorities;
 public:
     JobList() {}
     void add_job(::std::unique_ptr<Job> job);
+    /// Load (and later update) historical job durations, used to start long dependency chains first
+    void set_history_file(::helpers::path path);
     bool run_all(size_t num_jobs, bool dry_run);
 
 private:
+    void calculate_priorities();
+    bool dependencies_ready(const Job& job) const;
+    void mark_complete(const std::string& name, const std::vector<std::string>& dependencies);
+    /// Check for running jobs that have signalled that their metadata is ready, returns true if any have
+    bool poll_metadata();
+    /// Wait for a job to finish, or for a running job to make its metadata available
+    bool wait_for_progress();
+    void save_history() const;
     os_support::Process spawn(const RunnableJob& j);
     bool wait_one(bool block=true);
 };